@@ -0,0 +1,270 @@
+#include <riscv/sim.h>
+#include <sstream>
+
+// Checks that --host-fpu gives the same results and fflags as softfloat, for
+// operands covering the special cases, in every rounding mode, whether it is
+// static or taken from frm, and for single-precision operands that are not
+// properly NaN-boxed. Vector arithmetic, which takes the host FPU a batch of
+// elements at a time, is checked the same way with each frm.
+
+static uint32_t fp_op(unsigned funct7, unsigned rd, unsigned rs1, unsigned rs2, unsigned rm) {
+  return funct7 << 25 | rs2 << 20 | rs1 << 15 | rm << 12 | rd << 7 | 0x53;
+}
+
+static uint32_t fp_r4_op(unsigned opcode, unsigned fmt, unsigned rd, unsigned rs1,
+                         unsigned rs2, unsigned rs3, unsigned rm) {
+  return rs3 << 27 | fmt << 25 | rs2 << 20 | rs1 << 15 | rm << 12 | rd << 7 | opcode;
+}
+
+// vsetvli x5, x0 with LMUL=8, which sets vl to VLMAX
+static uint32_t vsetvli_m8(unsigned sew) {
+  unsigned vsew = sew == 32 ? 2 : 3;
+  return (vsew << 3 | 3) << 20 | 7 << 12 | 5 << 7 | 0x57;
+}
+
+static uint32_t v_op(unsigned funct6, unsigned funct3, unsigned vd, unsigned vs2, unsigned rs1) {
+  return funct6 << 26 | 1 << 25 | vs2 << 20 | rs1 << 15 | funct3 << 12 | vd << 7 | 0x57;
+}
+
+static const unsigned OPFVV = 1, OPFVF = 5;
+
+static freg_t box_s(uint32_t bits) { return freg_t{{0xffffffff00000000 | bits, UINT64_MAX}}; }
+static freg_t box_d(uint64_t bits) { return freg_t{{bits, UINT64_MAX}}; }
+
+// zeros, normals that round, the edges of the normal range, subnormals,
+// infinities and NaNs
+static const std::vector<freg_t> singles = {
+  box_s(0x00000000), box_s(0x80000000), box_s(0x3f800000), box_s(0xc0200000),
+  box_s(0x3eaaaaab), box_s(0x3dcccccd), box_s(0x00800000), box_s(0x00800001),
+  box_s(0x007fffff), box_s(0x00000001), box_s(0x7f7fffff), box_s(0x7e967699),
+  box_s(0x0da24260), box_s(0x7f800000), box_s(0xff800000), box_s(0x7fc00000),
+  box_s(0x7f800001), box_s(0xffc0abcd),
+  // 1.0 without the NaN-boxing, which reads as the canonical NaN
+  freg_t{{0x3f800000, 0}},
+};
+
+static const std::vector<freg_t> doubles = {
+  box_d(0x0000000000000000), box_d(0x8000000000000000), box_d(0x3ff0000000000000),
+  box_d(0xc004000000000000), box_d(0x3fd5555555555555), box_d(0x3fb999999999999a),
+  box_d(0x0010000000000000), box_d(0x0010000000000001), box_d(0x000fffffffffffff),
+  box_d(0x0000000000000001), box_d(0x7fefffffffffffff), box_d(0x7e37e43c8800759c),
+  box_d(0x01a56e1fc2f8f359), box_d(0x7ff0000000000000), box_d(0xfff0000000000000),
+  box_d(0x7ff8000000000000), box_d(0x7ff0000000000001), box_d(0xfff8000000abcdef),
+};
+
+// values whose sums, products and quotients mostly stay normal, so that
+// whole batches of vector elements can take the host FPU
+static const std::vector<freg_t> normal_singles = {
+  box_s(0x3f800000), box_s(0xc0200000), box_s(0x3eaaaaab), box_s(0x3dcccccd),
+  box_s(0x40490fdb), box_s(0xc2f6e979), box_s(0x00800001), box_s(0x7e967699),
+};
+
+static const std::vector<freg_t> normal_doubles = {
+  box_d(0x3ff0000000000000), box_d(0xc004000000000000), box_d(0x3fd5555555555555),
+  box_d(0x3fb999999999999a), box_d(0x400921fb54442d18), box_d(0xc05edd2f1a9fbe77),
+  box_d(0x0010000000000001), box_d(0x7e37e43c8800759c),
+};
+
+// static rounding modes, then the dynamic one with each frm
+static const std::vector<std::pair<unsigned, unsigned>> rounding = {
+  {0, 0}, {1, 0}, {2, 0}, {3, 0}, {4, 0}, {7, 0}, {7, 1}, {7, 2}, {7, 3}, {7, 4},
+};
+
+struct result_t {
+  std::string name;
+  freg_t rd;
+  reg_t fflags;
+};
+
+class fp_runner_t {
+public:
+  fp_runner_t(bool host_fpu) {
+    cfg.host_fpu = host_fpu;
+    cfg.isa = "rv64gcv";
+    for (const auto &mem_cfg : cfg.mem_layout)
+      mems.push_back(std::make_pair(mem_cfg.get_base(), new mem_t(mem_cfg.get_size())));
+    sim.reset(new sim_t(&cfg, false, mems, plugin_devices, htif_args, dm_config,
+                        nullptr,  // log_path
+                        true,     // dtb_enabled
+                        nullptr,  // dtb_file
+                        false,    // socket_enabled
+                        nullptr,  // cmd_file
+                        std::nullopt)); // instruction_limit
+    proc = sim->get_core(0);
+    proc->put_csr(CSR_MSTATUS, MSTATUS_FS | MSTATUS_VS);
+  }
+
+  // Runs insn once with f1, f2 and f3 holding the operands
+  void run(const std::string &name, uint32_t insn, const std::vector<freg_t> &operands,
+           unsigned frm) {
+    state_t *state = proc->get_state();
+    for (size_t i = 0; i < operands.size(); i++)
+      state->FPR.write(i + 1, operands[i]);
+    state->FPR.write(10, freg_t{{0, 0}});
+    execute({insn}, frm);
+
+    results.push_back({name, state->FPR[10], proc->get_csr(CSR_FFLAGS)});
+  }
+
+  // Runs insn once on whole register groups of sew-bit elements, with v8
+  // holding vs2, v16 holding vs1 and f1 holding rs1. Each element of the
+  // result in v24 is recorded as a result of its own.
+  void run_vector(const std::string &name, unsigned sew, uint32_t insn,
+                  const std::vector<freg_t> &vs2, const std::vector<freg_t> &vs1, freg_t rs1,
+                  unsigned frm) {
+    reg_t vlmax = proc->VU.get_vlen() / sew * 8;
+    for (reg_t i = 0; i < vlmax; i++) {
+      if (sew == 32) {
+        proc->VU.elt<uint32_t>(8, i, true) = vs2[i % vs2.size()].v[0];
+        proc->VU.elt<uint32_t>(16, i, true) = vs1[i % vs1.size()].v[0];
+        proc->VU.elt<uint32_t>(24, i, true) = 0;
+      } else {
+        proc->VU.elt<uint64_t>(8, i, true) = vs2[i % vs2.size()].v[0];
+        proc->VU.elt<uint64_t>(16, i, true) = vs1[i % vs1.size()].v[0];
+        proc->VU.elt<uint64_t>(24, i, true) = 0;
+      }
+    }
+    proc->get_state()->FPR.write(1, rs1);
+    execute({vsetvli_m8(sew), insn}, frm);
+
+    for (reg_t i = 0; i < vlmax; i++) {
+      reg_t vd = sew == 32 ? proc->VU.elt<uint32_t>(24, i) : proc->VU.elt<uint64_t>(24, i);
+      results.push_back({name + " element " + std::to_string(i), freg_t{{vd, 0}},
+                         proc->get_csr(CSR_FFLAGS)});
+    }
+  }
+
+  std::vector<result_t> results;
+
+private:
+  // Runs the instructions from their own addresses, so that no decoded
+  // instruction is reused
+  void execute(const std::vector<uint32_t> &insns, unsigned frm) {
+    size_t size = insns.size() * sizeof(insns[0]);
+    mems[0].second->store(offset, size, (const uint8_t *)insns.data());
+    proc->put_csr(CSR_FFLAGS, 0);
+    proc->put_csr(CSR_FRM, frm);
+    proc->get_state()->pc = mems[0].first + offset;
+    proc->step(insns.size());
+    offset += size;
+  }
+
+  reg_t offset = 0;
+  cfg_t cfg;
+  std::vector<device_factory_sargs_t> plugin_devices;
+  std::vector<std::string> htif_args{"none"};
+  debug_module_config_t dm_config;
+  std::vector<std::pair<reg_t, abstract_mem_t *>> mems;
+  std::unique_ptr<sim_t> sim;
+  processor_t *proc;
+};
+
+static std::string case_name(const char *op, unsigned rm, unsigned frm,
+                             const std::vector<freg_t> &operands) {
+  std::ostringstream s;
+  s << op << " rm=" << rm << " frm=" << frm << std::hex;
+  for (auto &x : operands)
+    s << " " << x.v[1] << ":" << x.v[0];
+  return s.str();
+}
+
+static void run_binary(fp_runner_t &runner, const char *op, unsigned funct7,
+                       const std::vector<freg_t> &values) {
+  for (auto [rm, frm] : rounding)
+    for (auto &a : values)
+      for (auto &b : values)
+        runner.run(case_name(op, rm, frm, {a, b}), fp_op(funct7, 10, 1, 2, rm), {a, b}, frm);
+}
+
+static void run_sqrt(fp_runner_t &runner, const char *op, unsigned funct7,
+                     const std::vector<freg_t> &values) {
+  for (auto [rm, frm] : rounding)
+    for (auto &a : values)
+      runner.run(case_name(op, rm, frm, {a}), fp_op(funct7, 10, 1, 0, rm), {a}, frm);
+}
+
+// the addend takes every other value, to keep the number of cases down
+static void run_fma(fp_runner_t &runner, const char *op, unsigned opcode, unsigned fmt,
+                    const std::vector<freg_t> &values) {
+  for (auto [rm, frm] : rounding)
+    for (auto &a : values)
+      for (auto &b : values)
+        for (size_t i = 0; i < values.size(); i += 2)
+          runner.run(case_name(op, rm, frm, {a, b, values[i]}),
+                     fp_r4_op(opcode, fmt, 10, 1, 2, 3, rm), {a, b, values[i]}, frm);
+}
+
+// vs1 is vs2 rotated by each amount in turn, which pairs every value with
+// every other one; the .vf forms take each value as the scalar
+static void run_vector(fp_runner_t &runner, const char *op, unsigned funct6, unsigned funct3,
+                       unsigned sew, const std::vector<freg_t> &values) {
+  for (unsigned frm = 0; frm <= 4; frm++) {
+    for (size_t r = 0; r < values.size(); r++) {
+      std::vector<freg_t> rotated(values.begin() + r, values.end());
+      rotated.insert(rotated.end(), values.begin(), values.begin() + r);
+      runner.run_vector(case_name(op, 7, frm, {values[r]}), sew,
+                        v_op(funct6, funct3, 24, 8, funct3 == OPFVV ? 16 : 1),
+                        values, rotated, values[r], frm);
+    }
+  }
+}
+
+static void run_vectors(fp_runner_t &runner, unsigned sew, const std::vector<freg_t> &values) {
+  run_vector(runner, "vfadd.vv", 0x00, OPFVV, sew, values);
+  run_vector(runner, "vfsub.vv", 0x02, OPFVV, sew, values);
+  run_vector(runner, "vfmul.vv", 0x24, OPFVV, sew, values);
+  run_vector(runner, "vfdiv.vv", 0x20, OPFVV, sew, values);
+  run_vector(runner, "vfadd.vf", 0x00, OPFVF, sew, values);
+  run_vector(runner, "vfsub.vf", 0x02, OPFVF, sew, values);
+  run_vector(runner, "vfrsub.vf", 0x27, OPFVF, sew, values);
+  run_vector(runner, "vfmul.vf", 0x24, OPFVF, sew, values);
+  run_vector(runner, "vfdiv.vf", 0x20, OPFVF, sew, values);
+  run_vector(runner, "vfrdiv.vf", 0x21, OPFVF, sew, values);
+}
+
+static std::vector<result_t> run(bool host_fpu) {
+  fp_runner_t runner(host_fpu);
+  run_binary(runner, "fadd.s", 0x00, singles);
+  run_binary(runner, "fsub.s", 0x04, singles);
+  run_binary(runner, "fmul.s", 0x08, singles);
+  run_binary(runner, "fadd.d", 0x01, doubles);
+  run_binary(runner, "fsub.d", 0x05, doubles);
+  run_binary(runner, "fmul.d", 0x09, doubles);
+  run_binary(runner, "fdiv.s", 0x0c, singles);
+  run_binary(runner, "fdiv.d", 0x0d, doubles);
+  run_sqrt(runner, "fsqrt.s", 0x2c, singles);
+  run_sqrt(runner, "fsqrt.d", 0x2d, doubles);
+  run_fma(runner, "fmadd.s", 0x43, 0, singles);
+  run_fma(runner, "fmsub.s", 0x47, 0, singles);
+  run_fma(runner, "fnmsub.s", 0x4b, 0, singles);
+  run_fma(runner, "fnmadd.s", 0x4f, 0, singles);
+  run_fma(runner, "fmadd.d", 0x43, 1, doubles);
+  run_fma(runner, "fmsub.d", 0x47, 1, doubles);
+  run_fma(runner, "fnmsub.d", 0x4b, 1, doubles);
+  run_fma(runner, "fnmadd.d", 0x4f, 1, doubles);
+  run_vectors(runner, 32, normal_singles);
+  run_vectors(runner, 32, singles);
+  run_vectors(runner, 64, normal_doubles);
+  run_vectors(runner, 64, doubles);
+  return runner.results;
+}
+
+int main() {
+  std::vector<result_t> host = run(true), soft = run(false);
+  size_t mismatches = 0;
+  for (size_t i = 0; i < host.size(); i++) {
+    if (host[i].rd.v[0] != soft[i].rd.v[0] || host[i].rd.v[1] != soft[i].rd.v[1] ||
+        host[i].fflags != soft[i].fflags) {
+      std::cerr << host[i].name << std::hex
+                << ": host FPU " << host[i].rd.v[1] << ":" << host[i].rd.v[0]
+                << " fflags " << host[i].fflags
+                << ", softfloat " << soft[i].rd.v[1] << ":" << soft[i].rd.v[0]
+                << " fflags " << soft[i].fflags << std::dec << std::endl;
+      mismatches++;
+    }
+  }
+  if (mismatches)
+    return 1;
+  std::cout << "Executed successfully" << std::endl;
+  return 0;
+}
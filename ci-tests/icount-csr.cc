@@ -0,0 +1,76 @@
+#include <riscv/sim.h>
+#include <riscv/debug_defines.h>
+
+// Checks that tdata1 reads while an icount trigger is armed return the same
+// count on the fast path, which counts instructions in bulk, as on the slow
+// path, which counts them one at a time.
+
+static uint32_t csrr(unsigned rd, unsigned csr) {
+  return csr << 20 | 2 << 12 | rd << 7 | 0x73;
+}
+
+static uint32_t csrw(unsigned csr, unsigned rs1) {
+  return csr << 20 | rs1 << 15 | 1 << 12 | 0x73;
+}
+
+static const uint32_t nop = 0x13;
+
+static reg_t icount_tdata1(reg_t count) {
+  reg_t tdata1 = 0;
+  tdata1 = set_field(tdata1, CSR_ICOUNT_TYPE(64), CSR_TDATA1_TYPE_ICOUNT);
+  tdata1 = set_field(tdata1, CSR_ICOUNT_COUNT, count);
+  tdata1 = set_field(tdata1, CSR_ICOUNT_M, 1);
+  return tdata1;
+}
+
+// Runs the program in M-mode and returns the count fields it read
+static std::vector<reg_t> run(bool slow_path) {
+  cfg_t cfg;
+  std::vector<device_factory_sargs_t> plugin_devices;
+  std::vector<std::string> htif_args{"none"};
+  debug_module_config_t dm_config;
+  std::vector<std::pair<reg_t, abstract_mem_t *>> mems;
+  for (const auto &mem_cfg : cfg.mem_layout)
+    mems.push_back(std::make_pair(mem_cfg.get_base(), new mem_t(mem_cfg.get_size())));
+  sim_t sim(&cfg, false, mems, plugin_devices, htif_args, dm_config,
+            nullptr,  // log_path
+            true,     // dtb_enabled
+            nullptr,  // dtb_file
+            false,    // socket_enabled
+            nullptr,  // cmd_file
+            std::nullopt); // instruction_limit
+
+  // a0 reads the count mid-run, a1 rewrites it, and a2 reads the new count
+  std::vector<uint32_t> prog = {nop, nop, nop, nop, csrr(10, CSR_TDATA1), nop, nop,
+                                csrw(CSR_TDATA1, 11), nop, nop, csrr(12, CSR_TDATA1), nop};
+  mems[0].second->store(0, prog.size() * sizeof(prog[0]), (const uint8_t *)prog.data());
+
+  processor_t *proc = sim.get_core(0);
+  state_t *state = proc->get_state();
+  // the commit log forces the slow path
+  if (slow_path)
+    proc->enable_log_commits();
+  state->pc = mems[0].first;
+  state->XPR.write(11, icount_tdata1(20));
+  // triggers with action=0 only count in M-mode while mstatus.MIE is set
+  proc->put_csr(CSR_MSTATUS, MSTATUS_MIE);
+  proc->put_csr(CSR_TSELECT, 0);
+  proc->put_csr(CSR_TDATA1, icount_tdata1(10));
+  proc->step(prog.size());
+
+  return {get_field(state->XPR[10], CSR_ICOUNT_COUNT),
+          get_field(state->XPR[12], CSR_ICOUNT_COUNT),
+          get_field(proc->get_csr(CSR_TDATA1), CSR_ICOUNT_COUNT)};
+}
+
+int main() {
+  std::vector<reg_t> fast = run(false), slow = run(true);
+  if (fast != slow) {
+    for (size_t i = 0; i < fast.size(); i++)
+      std::cerr << "count " << i << ": fast path " << fast[i]
+                << ", slow path " << slow[i] << std::endl;
+    return 1;
+  }
+  std::cout << "Executed successfully" << std::endl;
+  return 0;
+}
@@ -4,6 +4,7 @@
 #include "elf.h"
 #include "memif.h"
 #include "byteorder.h"
+#include <algorithm>
 #include <cstring>
 #include <string>
 #include <sys/stat.h>
@@ -19,7 +20,8 @@
 #include <cerrno>
 
 std::map<std::string, uint64_t> load_elf(const char* fn, memif_t* memif, reg_t* entry,
-                                         reg_t load_offset, unsigned required_xlen = 0)
+                                         reg_t load_offset, unsigned required_xlen = 0,
+                                         std::map<uint64_t, uint64_t>* symbol_ends = nullptr)
 {
   int fd = open(fn, O_RDONLY);
   struct stat s;
@@ -51,6 +53,7 @@ std::map<std::string, uint64_t> load_elf(const char* fn, memif_t* memif, reg_t*
   }
 
   std::vector<uint8_t> zeros;
+  std::vector<std::pair<reg_t, reg_t>> segments;
   std::map<std::string, uint64_t> symbols;
 
 #define LOAD_ELF(ehdr_t, phdr_t, shdr_t, sym_t, bswap)                         \
@@ -62,6 +65,8 @@ std::map<std::string, uint64_t> load_elf(const char* fn, memif_t* memif, reg_t*
     for (unsigned i = 0; i < bswap(eh->e_phnum); i++) {                        \
       if (bswap(ph[i].p_type) == PT_LOAD && bswap(ph[i].p_memsz)) {            \
         reg_t load_addr = bswap(ph[i].p_paddr) + load_offset;                  \
+        reg_t seg_addr = bswap(ph[i].p_vaddr) + load_offset;                   \
+        segments.emplace_back(seg_addr, seg_addr + bswap(ph[i].p_memsz));      \
         if (bswap(ph[i].p_filesz)) {                                           \
           assert(size >= bswap(ph[i].p_offset) + bswap(ph[i].p_filesz));       \
           memif->write(load_addr, bswap(ph[i].p_filesz),                       \
@@ -101,7 +106,19 @@ std::map<std::string, uint64_t> load_elf(const char* fn, memif_t* memif, reg_t*
             bswap(sh[strtabidx].sh_size) - bswap(sym[i].st_name);              \
         assert(bswap(sym[i].st_name) < bswap(sh[strtabidx].sh_size));          \
         assert(strnlen(strtab + bswap(sym[i].st_name), max_len) < max_len);    \
-        symbols[strtab + bswap(sym[i].st_name)] = bswap(sym[i].st_value) + load_offset;      \
+        reg_t value = bswap(sym[i].st_value) + load_offset;                    \
+        symbols[strtab + bswap(sym[i].st_name)] = value;                       \
+        if (symbol_ends) {                                                     \
+          /* unsized symbols, like assembly labels, extend to the end of */    \
+          /* their segment */                                                  \
+          reg_t end = value + bswap(sym[i].st_size);                           \
+          if (end == value)                                                    \
+            for (auto& [lo, hi] : segments)                                    \
+              if (value >= lo && value < hi)                                   \
+                end = hi;                                                      \
+          reg_t& known_end = (*symbol_ends)[value];                            \
+          known_end = std::max(known_end, end);                                \
+        }                                                                      \
       }                                                                        \
     }                                                                          \
   } while (0)
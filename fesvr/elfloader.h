@@ -9,7 +9,11 @@
 #include <string>
 
 class memif_t;
+// If symbol_ends is given, it maps the address of each symbol to the end of
+// the range the symbol covers: its st_size, or for unsized symbols the end
+// of the loaded segment they are in.
 std::map<std::string, uint64_t> load_elf(const char* fn, memif_t* memif, reg_t* entry,
-                                         reg_t load_offset, unsigned required_xlen = 0);
+                                         reg_t load_offset, unsigned required_xlen = 0,
+                                         std::map<uint64_t, uint64_t>* symbol_ends = nullptr);
 
 #endif
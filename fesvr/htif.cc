@@ -96,6 +96,8 @@ void htif_t::start()
     } else {
       auto empty_symbols = std::map<std::string, uint64_t>();
       load_symbols(empty_symbols);
+      // the target still boots, from a preloaded image
+      reset();
     }
   }
 }
@@ -147,7 +149,8 @@ std::map<std::string, uint64_t> htif_t::load_payload(const std::string& payload,
   } preload_aware_memif(this);
 
   try {
-    return load_elf(path.c_str(), &preload_aware_memif, entry, load_offset, expected_xlen);
+    return load_elf(path.c_str(), &preload_aware_memif, entry, load_offset, expected_xlen,
+                    &symbol_ends);
   } catch (mem_trap_t& t) {
     bad_address("loading payload " + payload, t.get_tval());
     abort();
@@ -166,7 +169,7 @@ void htif_t::load_symbols(std::map<std::string, uint64_t>& symbols)
   reg_t nop_entry;
   for (auto &s : symbol_elfs) {
     std::map<std::string, uint64_t> other_symbols = load_elf(s.c_str(), &nop_memif, &nop_entry,
-                                                             expected_xlen);
+                                                             expected_xlen, 0, &symbol_ends);
     symbols.merge(other_symbols);
   }
 
@@ -185,7 +188,7 @@ void htif_t::load_symbols(std::map<std::string, uint64_t>& symbols)
 
   for (auto i : symbols) {
     auto it = addr2symbol.find(i.second);
-    if ( it == addr2symbol.end())
+    if ( it == addr2symbol.end() || it->second.empty())
       addr2symbol[i.second] = i.first;
   }
 }
@@ -214,6 +217,22 @@ const char* htif_t::get_symbol(uint64_t addr)
   return it->second.c_str();
 }
 
+const char* htif_t::get_symbol_before(uint64_t addr)
+{
+  // skip section and file symbols, which have no names
+  for (auto it = addr2symbol.upper_bound(addr); it != addr2symbol.begin(); ) {
+    if (!(--it)->second.empty()) {
+      // past the end of the symbol, addr belongs to code without symbols
+      auto end = symbol_ends.find(it->first);
+      if (end != symbol_ends.end() && addr >= end->second)
+        return nullptr;
+      return it->second.c_str();
+    }
+  }
+
+  return nullptr;
+}
+
 bool htif_t::should_exit() const {
   return signal_exit || exitcode.has_value();
 }
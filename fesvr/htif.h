@@ -79,6 +79,9 @@ class htif_t : public chunked_memif_t
 
   // Given an address, return symbol from addr2symbol map
   const char* get_symbol(uint64_t addr);
+  // Given an address, return the closest named symbol at or below it, if
+  // the address is within the symbol's size or its loaded segment
+  const char* get_symbol_before(uint64_t addr);
 
   // Return true if the simulation should exit due to a signal,
   // or end-of-test from HTIF, or an instruction limit.
@@ -113,6 +116,8 @@ class htif_t : public chunked_memif_t
 
   std::vector<std::string> symbol_elfs;
   std::map<uint64_t, std::string> addr2symbol;
+  // end of the range each symbol address covers, from the ELF loader
+  std::map<uint64_t, uint64_t> symbol_ends;
 
   friend class memif_t;
   friend class syscall_t;
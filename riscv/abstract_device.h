@@ -11,6 +11,7 @@
 #include <vector>
 
 class sim_t;
+class checkpoint_buf_t;
 
 class abstract_device_t {
  public:
@@ -19,6 +20,18 @@ class abstract_device_t {
   virtual reg_t size() = 0;
   virtual ~abstract_device_t() {}
   virtual void tick(reg_t UNUSED rtc_ticks) {}
+
+  // Devices whose contents behave like plain memory may expose them so that
+  // the MMU can map them like RAM.  Returns a host pointer to the byte at
+  // addr, valid through the end of its page, or nullptr if accesses of this
+  // kind (stores if write is set, else loads and fetches) must go through
+  // load() and store().
+  virtual char* host_span(reg_t UNUSED addr, bool UNUSED write) { return nullptr; }
+
+  // Devices with state of their own add it to checkpoints here.  restore()
+  // must read back exactly what save() wrote.
+  virtual void save(checkpoint_buf_t& UNUSED buf) {}
+  virtual void restore(checkpoint_buf_t& UNUSED buf) {}
 };
 
 // factory for devices which should show up in the DTS, and can be
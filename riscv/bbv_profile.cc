@@ -0,0 +1,25 @@
+// See LICENSE for license details.
+
+#include "bbv_profile.h"
+#include <algorithm>
+#include <cinttypes>
+#include <utility>
+#include <vector>
+
+void bbv_profile_t::end_interval()
+{
+  // blocks first entered in the same interval get their ids in pc order
+  std::vector<std::pair<uint64_t, uint64_t>> vec(counts.begin(), counts.end());
+  std::sort(vec.begin(), vec.end());
+  counts.clear();
+
+  for (auto& [key, count] : vec)
+    key = ids.try_emplace(key, ids.size() + 1).first->second;
+  std::sort(vec.begin(), vec.end());
+
+  FILE* f = out.get();
+  fputc('T', f);
+  for (auto& [id, count] : vec)
+    fprintf(f, ":%" PRIu64 ":%" PRIu64 " ", id, count);
+  fputc('\n', f);
+}
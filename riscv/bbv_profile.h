@@ -0,0 +1,38 @@
+// See LICENSE for license details.
+#ifndef _RISCV_BBV_PROFILE_H
+#define _RISCV_BBV_PROFILE_H
+
+#include <stdio.h>
+#include <unordered_map>
+#include "decode.h"
+#include "log_file.h"
+
+// Basic-block vectors of one hart, selected with --bbv, in the format read
+// by SimPoint: every interval instructions, one line "T:<id>:<count> ..."
+// with the number of instructions each basic block retired in the
+// interval. A basic block is named after the pc control transferred to, and
+// its id is the order in which it was first entered, from 1.
+class bbv_profile_t
+{
+public:
+  bbv_profile_t(reg_t interval, const char* path) : interval(interval), out(path) {}
+
+  reg_t get_interval() const { return interval; }
+
+  void add(reg_t block_pc, reg_t insns)
+  {
+    if (insns)
+      counts[block_pc] += insns;
+  }
+
+  // Writes the vector of the interval that just ended, and starts the next
+  void end_interval();
+
+private:
+  reg_t interval;
+  log_file_t out;
+  std::unordered_map<reg_t, uint64_t> counts; // in the current interval
+  std::unordered_map<reg_t, uint64_t> ids;
+};
+
+#endif
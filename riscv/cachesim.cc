@@ -77,6 +77,19 @@ void cache_sim_t::init()
     idx_shift++;
 
   tags = new uint64_t[sets*ways]();
+  reset_stats();
+
+  miss_handler = NULL;
+}
+
+/**
+ * @brief Clears the statistics, keeping the contents of the cache
+ * 
+ * @param None
+ * @return None
+ */
+void cache_sim_t::reset_stats()
+{
   read_accesses = 0;
   read_misses = 0;
   bytes_read = 0;
@@ -84,8 +97,6 @@ void cache_sim_t::init()
   write_misses = 0;
   bytes_written = 0;
   writebacks = 0;
-
-  miss_handler = NULL;
 }
 
 /**
@@ -96,6 +96,16 @@ class cache_sim_t
   void access(uint64_t addr, size_t bytes, bool store);
   void clean_invalidate(uint64_t addr, size_t bytes, bool clean, bool inval);
   void print_stats();
+  /**
+   * @brief Clears the hit/miss statistics, keeping the contents of the cache
+   *
+   * Lets a cache be warmed up before the accesses of interest are counted
+   */
+  void reset_stats();
+  /**
+   * @brief Checks whether any access was counted since the statistics were last cleared
+   */
+  bool has_accesses() const { return read_accesses + write_accesses != 0; }
   void set_miss_handler(cache_sim_t* mh) { miss_handler = mh; }
   /**
    * @brief Enables or disables logging for this cache
@@ -273,6 +283,14 @@ class cache_memtracer_t : public memtracer_t
   {
     cache->print_stats();
   }
+  void reset_stats()
+  {
+    cache->reset_stats();
+  }
+  bool has_accesses() const
+  {
+    return cache->has_accesses();
+  }
 
  protected:
   cache_sim_t* cache;
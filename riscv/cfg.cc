@@ -7,7 +7,8 @@
 #include "encoding.h"
 #include "platform.h"
 
-mem_cfg_t::mem_cfg_t(reg_t base, reg_t size) : base(base), size(size)
+mem_cfg_t::mem_cfg_t(reg_t base, reg_t size, mem_backing_cfg_t backing)
+  : base(base), size(size), backing(backing)
 {
   assert(mem_cfg_t::check_if_supported(base, size));
 }
@@ -48,4 +49,5 @@ cfg_t::cfg_t()
   real_time_clint  = false;
   trigger_count    = 4;
   cache_blocksz    = 64;
+  host_fpu         = false;
 }
@@ -3,6 +3,7 @@
 #define _RISCV_CFG_H
 
 #include <optional>
+#include <string>
 #include <vector>
 #include "decode.h"
 #include <cassert>
@@ -34,13 +35,29 @@ private:
   bool was_set;
 };
 
+// Host-side backing and placement of the storage for a memory region.
+// Setting any of them makes the region a single contiguous host mapping
+// rather than a sparse set of lazily-allocated pages.
+struct mem_backing_cfg_t
+{
+  bool hugepages = false;             // madvise(MADV_HUGEPAGE) the mapping
+  std::optional<unsigned> numa_node;  // mbind the mapping to this host node
+  std::string path;                   // map this host file over the region
+  bool shm = false;                   // path names a POSIX shared memory object
+  bool shared = false;                // write guest stores back to path
+
+  bool contiguous() const {
+    return hugepages || numa_node.has_value() || !path.empty();
+  }
+};
+
 // Configuration that describes a memory region
 class mem_cfg_t
 {
 public:
   static bool check_if_supported(reg_t base, reg_t size);
 
-  mem_cfg_t(reg_t base, reg_t size);
+  mem_cfg_t(reg_t base, reg_t size, mem_backing_cfg_t backing = {});
 
   reg_t get_base() const {
     return base;
@@ -54,9 +71,14 @@ public:
     return base + size - 1;
   }
 
+  const mem_backing_cfg_t& get_backing() const {
+    return backing;
+  }
+
 private:
   reg_t base;
   reg_t size;
+  mem_backing_cfg_t backing;
 };
 
 class cfg_t
@@ -79,6 +101,7 @@ public:
   bool                    real_time_clint;
   reg_t                   trigger_count;
   reg_t                   cache_blocksz;
+  bool                    host_fpu;
   std::optional<abstract_sim_if_t*> external_simulator;
 
   size_t nprocs() const { return hartids.size(); }
@@ -0,0 +1,114 @@
+// See LICENSE for license details.
+#ifndef _RISCV_CHECKPOINT_H
+#define _RISCV_CHECKPOINT_H
+
+// Full-system checkpoints, for --checkpoint-save and --checkpoint-restore.
+//
+// A checkpoint file starts with a checkpoint_file_header_t, followed by the
+// state of the simulator, its harts and its devices, serialized into a
+// checkpoint_buf_t. The contents of each memory region follow, in the order
+// of sim_t::mems, each at an offset aligned to CHECKPOINT_ALIGN. A memory
+// image is a sparse file region: pages the guest never touched, or that are
+// all zeros, are holes, so they take no disk space, and restoring maps the
+// images copy-on-write so that pages are only read when the guest uses them.
+//
+// Checkpoints hold architectural state only, so they must be restored by a
+// simulator started with the same configuration and program.
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#define CHECKPOINT_MAGIC "SPKCKPT"
+#define CHECKPOINT_VERSION 1
+
+// Larger than the page size of any host, so the images can be mapped
+static const uint64_t CHECKPOINT_ALIGN = 1 << 16;
+
+struct checkpoint_file_header_t
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t nmems;
+  uint64_t state_size; // of the serialized state, in bytes
+  uint64_t mems_offset; // of the first memory image
+};
+
+// A flat buffer of serialized state. put() appends values in host byte
+// order, and get() reads them back in the same order, throwing if the
+// buffer runs out.
+class checkpoint_buf_t
+{
+public:
+  checkpoint_buf_t() : pos(0) {}
+
+  void put_bytes(const void* bytes, size_t len)
+  {
+    data.insert(data.end(), (const char*)bytes, (const char*)bytes + len);
+  }
+
+  void get_bytes(void* bytes, size_t len)
+  {
+    if (data.size() - pos < len)
+      throw std::runtime_error("checkpoint is truncated");
+    memcpy(bytes, &data[pos], len);
+    pos += len;
+  }
+
+  template<typename T> void put(const T& value)
+  {
+    static_assert(std::is_trivially_copyable_v<T>);
+    put_bytes(&value, sizeof(value));
+  }
+
+  template<typename T> T get()
+  {
+    static_assert(std::is_trivially_copyable_v<T>);
+    T value;
+    get_bytes(&value, sizeof(value));
+    return value;
+  }
+
+  template<typename T> void get(T* value)
+  {
+    static_assert(std::is_trivially_copyable_v<T>);
+    get_bytes(value, sizeof(*value));
+  }
+
+  std::vector<char> data;
+  size_t pos;
+};
+
+// pwrite() and pread() all of [data, data + len), or throw
+inline void checkpoint_pwrite(int fd, const void* data, size_t len, uint64_t offset)
+{
+  for (size_t done = 0; done < len; ) {
+    ssize_t n = pwrite(fd, (const char*)data + done, len - done, offset + done);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      throw std::runtime_error(std::string("unable to write checkpoint: ") + strerror(errno));
+    done += n;
+  }
+}
+
+inline void checkpoint_pread(int fd, void* data, size_t len, uint64_t offset)
+{
+  for (size_t done = 0; done < len; ) {
+    ssize_t n = pread(fd, (char*)data + done, len - done, offset + done);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n < 0)
+      throw std::runtime_error(std::string("unable to read checkpoint: ") + strerror(errno));
+    if (n == 0)
+      throw std::runtime_error("checkpoint is truncated");
+    done += n;
+  }
+}
+
+#endif
@@ -5,6 +5,7 @@
 #include "simif.h"
 #include "sim.h"
 #include "dts.h"
+#include "checkpoint.h"
 
 clint_t::clint_t(const simif_t* sim, uint64_t freq_hz, bool real_time)
   : sim(sim), freq_hz(freq_hz), real_time(real_time), mtime(0)
@@ -118,6 +119,27 @@ void clint_t::tick(reg_t rtc_ticks)
   }
 }
 
+void clint_t::save(checkpoint_buf_t& buf)
+{
+  buf.put(mtime);
+  buf.put<uint64_t>(mtimecmp.size());
+  for (const auto& [hart_id, cmp] : mtimecmp) {
+    buf.put<uint64_t>(hart_id);
+    buf.put(cmp);
+  }
+}
+
+void clint_t::restore(checkpoint_buf_t& buf)
+{
+  buf.get(&mtime);
+  mtimecmp.clear();
+  for (auto n = buf.get<uint64_t>(); n > 0; n--) {
+    auto hart_id = buf.get<uint64_t>();
+    buf.get(&mtimecmp[hart_id]);
+  }
+  tick(0);
+}
+
 clint_t* clint_parse_from_fdt(const void* fdt, const sim_t* sim, reg_t* base,
     const std::vector<std::string>& sargs UNUSED) {
   if (fdt_parse_clint(fdt, base, "riscv,clint0") == 0 || fdt_parse_clint(fdt, base, "sifive,clint0") == 0)
@@ -0,0 +1,216 @@
+// See LICENSE for license details.
+
+#include "commit_log.h"
+#include "disasm.h"
+#include <cassert>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+
+static void commit_log_print_value(FILE *log_file, int width, const void *data)
+{
+  assert(log_file);
+
+  switch (width) {
+    case 8:
+      fprintf(log_file, "0x%02" PRIx8, *(const uint8_t *)data);
+      break;
+    case 16:
+      fprintf(log_file, "0x%04" PRIx16, *(const uint16_t *)data);
+      break;
+    case 32:
+      fprintf(log_file, "0x%08" PRIx32, *(const uint32_t *)data);
+      break;
+    case 64:
+      fprintf(log_file, "0x%016" PRIx64, *(const uint64_t *)data);
+      break;
+    default:
+      if (width % 8 == 0) {
+        const uint8_t *arr = (const uint8_t *)data;
+
+        fprintf(log_file, "0x");
+        for (int idx = width / 8 - 1; idx >= 0; --idx) {
+          fprintf(log_file, "%02" PRIx8, arr[idx]);
+        }
+      } else {
+        abort();
+      }
+      break;
+  }
+}
+
+static void commit_log_print_value(FILE *log_file, int width, uint64_t val)
+{
+  commit_log_print_value(log_file, width, &val);
+}
+
+void commit_log_print_text(FILE *log_file, const commit_log_rec_t *rec, reg_t vlen)
+{
+  const char *p = (const char *)(rec + 1);
+  int xlen = rec->xlen;
+  int flen = rec->flen;
+
+  // print core id on all lines so it is easy to grep
+  fprintf(log_file, "core%4" PRId32 ": ", rec->hartid);
+
+  fprintf(log_file, "%1d ", rec->priv);
+  commit_log_print_value(log_file, xlen, rec->pc);
+  fprintf(log_file, " (");
+  commit_log_print_value(log_file, rec->insn_length * 8, rec->insn);
+  fprintf(log_file, ")");
+  bool show_vec = false;
+
+  for (uint32_t i = 0; i < rec->nregs; i++) {
+    commit_log_rec_reg_t item;
+    memcpy(&item, p, sizeof(item));
+    p += sizeof(item);
+
+    char prefix = ' ';
+    int size;
+    int rd = item.key >> 4;
+    bool is_vec = false;
+    bool is_vreg = false;
+    switch (item.key & 0xf) {
+    case 0:
+      size = xlen;
+      prefix = 'x';
+      break;
+    case 1:
+      size = flen;
+      prefix = 'f';
+      break;
+    case 2:
+      size = vlen;
+      prefix = 'v';
+      is_vreg = true;
+      break;
+    case 3:
+      is_vec = true;
+      break;
+    case 4:
+      size = xlen;
+      prefix = 'c';
+      break;
+    default:
+      assert("can't been here" && 0);
+      break;
+    }
+
+    if (!show_vec && (is_vreg || is_vec)) {
+        fprintf(log_file, " e%ld %s%ld l%ld",
+                (long)rec->vsew,
+                rec->vflmul < 1 ? "mf" : "m",
+                rec->vflmul < 1 ? (long)(1 / rec->vflmul) : (long)rec->vflmul,
+                (long)rec->vl);
+        show_vec = true;
+    }
+
+    if (!is_vec) {
+      if (prefix == 'c')
+        fprintf(log_file, " c%d_%s ", rd, csr_name(rd));
+      else
+        fprintf(log_file, " %c%-2d ", prefix, rd);
+      if (is_vreg) {
+        commit_log_print_value(log_file, size, p);
+        p += vlen / 8;
+      } else {
+        commit_log_print_value(log_file, size, item.val);
+      }
+    }
+  }
+
+  for (uint32_t i = 0; i < rec->nloads; i++) {
+    uint64_t addr;
+    memcpy(&addr, p, sizeof(addr));
+    p += sizeof(addr);
+    fprintf(log_file, " mem ");
+    commit_log_print_value(log_file, xlen, addr);
+  }
+
+  for (uint32_t i = 0; i < rec->nstores; i++) {
+    commit_log_rec_store_t item;
+    memcpy(&item, p, sizeof(item));
+    p += sizeof(item);
+    fprintf(log_file, " mem ");
+    commit_log_print_value(log_file, xlen, item.addr);
+    fprintf(log_file, " ");
+    commit_log_print_value(log_file, item.size << 3, item.val);
+  }
+  fprintf(log_file, "\n");
+}
+
+static std::mutex open_writers_lock;
+static std::set<commit_log_writer_t*> open_writers;
+
+commit_log_writer_t::commit_log_writer_t(FILE *file, reg_t vlen)
+  : file(file), ring(size_t(1) << 24), pending_head(0), cached_tail(0),
+    head(0), tail(0), done(false)
+{
+  commit_log_file_header_t header = {};
+  memcpy(header.magic, COMMIT_LOG_MAGIC, sizeof(header.magic));
+  header.version = COMMIT_LOG_VERSION;
+  header.vlen = vlen;
+  if (fwrite(&header, sizeof(header), 1, file) != 1)
+    throw std::runtime_error("Failed to write commit log header");
+
+  writer = std::thread(&commit_log_writer_t::drain, this);
+
+  std::lock_guard<std::mutex> lock(open_writers_lock);
+  static bool registered = false;
+  if (!registered) {
+    atexit(close_all);
+    registered = true;
+  }
+  open_writers.insert(this);
+}
+
+commit_log_writer_t::~commit_log_writer_t()
+{
+  close();
+  std::lock_guard<std::mutex> lock(open_writers_lock);
+  open_writers.erase(this);
+}
+
+void commit_log_writer_t::close()
+{
+  if (!writer.joinable())
+    return;
+
+  commit();
+  done.store(true, std::memory_order_release);
+  writer.join();
+  fflush(file);
+}
+
+// exit() skips the destructors of the writers' owners
+void commit_log_writer_t::close_all()
+{
+  std::lock_guard<std::mutex> lock(open_writers_lock);
+  for (auto writer : open_writers)
+    writer->close();
+}
+
+void commit_log_writer_t::drain()
+{
+  size_t t = tail.load(std::memory_order_relaxed);
+  while (true) {
+    bool finishing = done.load(std::memory_order_acquire);
+    size_t h = head.load(std::memory_order_acquire);
+    if (h == t) {
+      if (finishing)
+        break;
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+      continue;
+    }
+
+    size_t offset = t & (ring.size() - 1);
+    size_t n = std::min(h - t, ring.size() - offset);
+    if (fwrite(&ring[offset], 1, n, file) != n) {
+      fprintf(stderr, "Failed to write commit log: %s\n", strerror(errno));
+      abort();
+    }
+    t += n;
+    tail.store(t, std::memory_order_release);
+  }
+}
@@ -0,0 +1,137 @@
+// See LICENSE for license details.
+#ifndef _RISCV_COMMIT_LOG_H
+#define _RISCV_COMMIT_LOG_H
+
+// Binary commit log, selected with --log-commits-format=binary.
+//
+// The file starts with a commit_log_file_header_t, followed by one record
+// per committed instruction: a commit_log_rec_t, then nregs register writes
+// (each a commit_log_rec_reg_t, followed for vector registers by vlen/8
+// bytes of register contents), nloads load addresses (uint64_t each) and
+// nstores commit_log_rec_store_t. All fields are in host byte order.
+// commit_log_print_text() turns a record back into a line of the text log.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <optional>
+#include <thread>
+#include <vector>
+#include "decode.h"
+
+#define COMMIT_LOG_MAGIC "SPKCLOG"
+#define COMMIT_LOG_VERSION 1
+
+struct commit_log_file_header_t
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t vlen;
+};
+
+struct commit_log_rec_t
+{
+  uint64_t pc;
+  uint64_t insn;
+  uint64_t vl;
+  float vflmul;
+  uint32_t size; // of the whole record, in bytes
+  uint32_t hartid;
+  uint32_t nregs;
+  uint32_t nloads;
+  uint32_t nstores;
+  uint16_t vsew;
+  uint8_t priv;
+  uint8_t xlen;
+  uint8_t flen;
+  uint8_t insn_length;
+  uint8_t pad[2];
+};
+
+struct commit_log_rec_reg_t
+{
+  uint64_t key; // as in state_t::log_reg_write
+  uint64_t val[2];
+};
+
+struct commit_log_rec_store_t
+{
+  uint64_t addr;
+  uint64_t val;
+  uint64_t size;
+};
+
+// Restricts --log-commits to part of the execution: an instruction is
+// logged only if it passes every filter that is set.
+struct commit_log_filter_t
+{
+  std::optional<std::pair<reg_t, reg_t>> pc_range; // [lo, hi)
+  unsigned priv_mask = ~0u; // bit PRV_x set to log privilege mode x
+  std::optional<std::pair<reg_t, reg_t>> window; // start instret, count
+
+  bool any() const { return pc_range || priv_mask != ~0u || window; }
+  bool in_pc_range(reg_t pc) const
+  {
+    return !pc_range || pc - pc_range->first < pc_range->second - pc_range->first;
+  }
+};
+
+// Prints the record rec, which must be rec->size bytes long.
+void commit_log_print_text(FILE *log_file, const commit_log_rec_t *rec, reg_t vlen);
+
+// Streams records to a file. The simulator thread copies each record into a
+// single-producer/single-consumer ring buffer, and a writer thread drains
+// the ring to the file, so the simulator never waits on I/O unless the
+// ring fills up. Writers still open when the process calls exit() are
+// closed from an atexit handler, so the ring is never lost.
+class commit_log_writer_t
+{
+public:
+  commit_log_writer_t(FILE *file, reg_t vlen);
+  ~commit_log_writer_t();
+
+  void write(const void *data, size_t len)
+  {
+    const char *src = (const char *)data;
+    while (len > 0) {
+      size_t free = ring.size() - (pending_head - cached_tail);
+      if (free == 0) {
+        commit();
+        cached_tail = tail.load(std::memory_order_acquire);
+        if (cached_tail + ring.size() == pending_head)
+          std::this_thread::yield();
+        continue;
+      }
+
+      size_t offset = pending_head & (ring.size() - 1);
+      size_t n = std::min(len, std::min(free, ring.size() - offset));
+      memcpy(&ring[offset], src, n);
+      pending_head += n;
+      src += n;
+      len -= n;
+    }
+  }
+
+  // makes everything written so far visible to the writer thread
+  void commit() { head.store(pending_head, std::memory_order_release); }
+
+  // writes out everything written so far and stops the writer thread
+  void close();
+
+private:
+  void drain();
+  static void close_all();
+
+  FILE *file;
+  std::vector<char> ring;
+  size_t pending_head;
+  size_t cached_tail;
+  alignas(64) std::atomic<size_t> head;
+  alignas(64) std::atomic<size_t> tail;
+  std::atomic<bool> done;
+  std::thread writer;
+};
+
+#endif
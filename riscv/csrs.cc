@@ -125,6 +125,7 @@ bool pmpaddr_csr_t::unlogged_write(const reg_t val) noexcept {
   }
   else
     return false;
+  proc->get_mmu()->flush_pmp();
   proc->get_mmu()->flush_tlb();
   return true;
 }
@@ -160,26 +161,18 @@ bool pmpaddr_csr_t::match4(reg_t addr) const noexcept {
   return ((addr ^ tor_paddr()) & napot_mask()) == 0;
 }
 
-bool pmpaddr_csr_t::subset_match(reg_t addr, reg_t len) const noexcept {
-  if ((addr | len) & (len - 1))
-    abort();
-  reg_t base = tor_base_paddr();
-  reg_t tor = tor_paddr();
-
+bool pmpaddr_csr_t::match_range(reg_t* base, reg_t* last) const noexcept {
   if ((cfg & PMP_A) == 0) return false;
-
   bool is_tor = (cfg & PMP_A) == PMP_TOR;
-  bool begins_after_lower = addr >= base;
-  bool begins_after_upper = addr >= tor;
-  bool ends_before_lower = (addr & -len) < (base & -len);
-  bool ends_before_upper = (addr & -len) < (tor & -len);
-  bool tor_homogeneous = ends_before_lower || begins_after_upper ||
-    (begins_after_lower && ends_before_upper);
-
-  bool mask_homogeneous = ~(napot_mask() << 1) & len;
-  bool napot_homogeneous = mask_homogeneous || ((addr ^ tor) / len) != 0;
-
-  return !(is_tor ? tor_homogeneous : napot_homogeneous);
+  if (is_tor) {
+    *base = tor_base_paddr();
+    *last = tor_paddr() - 1;
+    return tor_base_paddr() < tor_paddr();
+  }
+  // NAPOT or NA4:
+  *base = tor_paddr() & napot_mask();
+  *last = *base | ~napot_mask();
+  return true;
 }
 
 bool pmpaddr_csr_t::access_ok(access_type type, reg_t mode, bool hlvx) const noexcept {
@@ -276,6 +269,7 @@ bool pmpcfg_csr_t::unlogged_write(const reg_t val) noexcept {
       write_success = true;
     }
   }
+  proc->get_mmu()->flush_pmp();
   proc->get_mmu()->flush_tlb();
   return write_success;
 }
@@ -465,7 +459,7 @@ reg_t base_status_csr_t::adjust_sd(const reg_t val) const noexcept {
 
 void base_status_csr_t::maybe_flush_tlb(const reg_t newval) noexcept {
   if ((newval ^ read()) &
-      (MSTATUS_MPP | MSTATUS_MPRV
+      (MSTATUS_MPP | MSTATUS_MPRV | MSTATUS_UXL | MSTATUS_SXL
        | (has_page ? (MSTATUS_MXR | MSTATUS_SUM) : 0)
       ))
     proc->get_mmu()->flush_tlb();
@@ -593,6 +587,8 @@ bool mnstatus_csr_t::unlogged_write(const reg_t val) noexcept {
   const reg_t requested_mnpp = proc->legalize_privilege(get_field(val, MNSTATUS_MNPP));
   const reg_t adjusted_val = set_field(val, MNSTATUS_MNPP, requested_mnpp);
   const reg_t new_mnstatus = (read() & ~mask) | (adjusted_val & mask);
+  if ((new_mnstatus ^ read()) & MNSTATUS_NMIE)
+    proc->get_mmu()->flush_tlb(); // in_mprv() depends on NMIE
 
   return basic_csr_t::unlogged_write(new_mnstatus);
 }
@@ -98,8 +98,9 @@ class pmpaddr_csr_t: public csr_t {
   // Does a 4-byte access at the specified address match this PMP entry?
   bool match4(reg_t addr) const noexcept;
 
-  // Does the specified range match only a proper subset of this page?
-  bool subset_match(reg_t addr, reg_t len) const noexcept;
+  // The inclusive paddr range [*base, *last] that match4() accepts.
+  // Returns false if the entry is off or matches nothing.
+  bool match_range(reg_t* base, reg_t* last) const noexcept;
 
   // Is the specified access allowed given the pmpcfg privileges?
   bool access_ok(access_type type, reg_t mode, bool hlvx) const noexcept;
@@ -381,6 +382,8 @@ class mip_csr_t: public mip_or_mie_csr_t {
 
   // Does not log. Used by external things (clint) that wiggle bits in mip.
   void backdoor_write_with_mask(const reg_t mask, const reg_t val) noexcept;
+  // Excludes the bits aliased from hvip and mvip. Used by checkpoints.
+  reg_t backdoor_read() const noexcept { return val; }
  private:
   virtual reg_t write_mask() const noexcept override;
 };
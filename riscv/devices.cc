@@ -1,6 +1,20 @@
 #include "devices.h"
 #include "mmu.h"
+#include "checkpoint.h"
 #include <stdexcept>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+#ifndef MPOL_BIND
+#define MPOL_BIND 2
+#endif
 
 mmio_device_map_t& mmio_device_map()
 {
@@ -16,8 +30,10 @@ bus_t::bus_t()
 }
 
 bus_t::bus_t(abstract_device_t* fallback)
-  : fallback(fallback)
+  : fallback(fallback), dispatch_root(new dispatch_node_t),
+    last_base(0), last_size(0), last_dev(nullptr)
 {
+  dispatch_nodes.emplace_back(dispatch_root);
 }
 
 void bus_t::add_device(reg_t addr, abstract_device_t* dev)
@@ -44,6 +60,54 @@ void bus_t::add_device(reg_t addr, abstract_device_t* dev)
   }
 
   devices[addr] = dev;
+
+  // Pages wholly inside the device dispatch straight to it; a partly
+  // covered page at either end may be shared with other devices.
+  reg_t end = addr + size - 1;
+  reg_t first_page = addr >> PGSHIFT, last_page = end >> PGSHIFT;
+  reg_t partial_head = addr % PGSIZE != 0;
+  reg_t partial_tail = end % PGSIZE != PGSIZE - 1;
+  if (first_page + partial_head + partial_tail <= last_page) {
+    dispatch_targets.push_back({addr, size, dev});
+    dispatch_insert(dispatch_root, 0, 0, first_page + partial_head,
+                    last_page - partial_tail, &dispatch_targets.back());
+  }
+  if (partial_head)
+    dispatch_insert(dispatch_root, 0, 0, first_page, first_page, nullptr);
+  if (partial_tail)
+    dispatch_insert(dispatch_root, 0, 0, last_page, last_page, nullptr);
+
+  last_size = 0;
+}
+
+// Map pages [first_page, last_page] to target, or mark them ambiguous if
+// target is null.  node spans the pages starting at node_first_page.
+void bus_t::dispatch_insert(dispatch_node_t* node, unsigned level, reg_t node_first_page,
+                            reg_t first_page, reg_t last_page,
+                            const dispatch_target_t* target)
+{
+  const unsigned shift = (DISPATCH_LEVELS - 1 - level) * DISPATCH_BITS;
+  const reg_t lo = (first_page - node_first_page) >> shift;
+  const reg_t hi = (last_page - node_first_page) >> shift;
+
+  for (reg_t i = lo; i <= hi; i++) {
+    auto& slot = node->slots[i];
+    reg_t slot_first = node_first_page + (i << shift);
+    reg_t slot_last = slot_first + (reg_t(1) << shift) - 1;
+
+    if (target && !(slot & DISPATCH_CHILD) && first_page <= slot_first && slot_last <= last_page) {
+      slot = reinterpret_cast<dispatch_slot_t>(target);
+    } else if (level == DISPATCH_LEVELS - 1) {
+      slot = DISPATCH_AMBIGUOUS;
+    } else {
+      if (!(slot & DISPATCH_CHILD)) {
+        dispatch_nodes.emplace_back(new dispatch_node_t);
+        slot = reinterpret_cast<dispatch_slot_t>(dispatch_nodes.back().get()) | DISPATCH_CHILD;
+      }
+      dispatch_insert(reinterpret_cast<dispatch_node_t*>(slot - DISPATCH_CHILD), level + 1, slot_first,
+                      std::max(first_page, slot_first), std::min(last_page, slot_last), target);
+    }
+  }
 }
 
 bool bus_t::load(reg_t addr, size_t len, uint8_t* bytes)
@@ -72,6 +136,43 @@ std::pair<reg_t, abstract_device_t*> bus_t::find_device(reg_t addr, size_t len)
   if (unlikely(!len || addr + len - 1 < addr))
     return std::make_pair(0, nullptr);
 
+  if (likely(addr >= last_base && addr - last_base + len - 1 < last_size))
+    return std::make_pair(last_base, last_dev);
+
+  const dispatch_node_t* node = dispatch_root;
+  for (unsigned level = 0; level < DISPATCH_LEVELS; level++) {
+    const unsigned shift = (DISPATCH_LEVELS - 1 - level) * DISPATCH_BITS + PGSHIFT;
+    const dispatch_slot_t slot = node->slots[(addr >> shift) & ((reg_t(1) << DISPATCH_BITS) - 1)];
+
+    if (slot & DISPATCH_CHILD) {
+      node = reinterpret_cast<const dispatch_node_t*>(slot - DISPATCH_CHILD);
+      continue;
+    }
+
+    if (slot == DISPATCH_AMBIGUOUS)
+      break;
+
+    if (slot) {
+      auto target = reinterpret_cast<const dispatch_target_t*>(slot);
+      if (likely(addr - target->base + len - 1 < target->size)) {
+        last_base = target->base;
+        last_size = target->size;
+        last_dev = target->dev;
+        return std::make_pair(target->base, target->dev);
+      }
+    } else if (((addr ^ (addr + len - 1)) >> shift) == 0) {
+      // No device anywhere in this slot's span
+      return std::make_pair(0, fallback);
+    }
+
+    break;
+  }
+
+  return find_device_slow(addr, len);
+}
+
+std::pair<reg_t, abstract_device_t*> bus_t::find_device_slow(reg_t addr, size_t len)
+{
   // Obtain iterator to device immediately after the one that might match
   auto it_after = devices.upper_bound(addr);
   reg_t base, size;
@@ -96,15 +197,111 @@ std::pair<reg_t, abstract_device_t*> bus_t::find_device(reg_t addr, size_t len)
   return std::make_pair(0, fallback);
 }
 
-mem_t::mem_t(reg_t size)
-  : sz(size)
+mem_t::mem_t(reg_t size, const mem_backing_cfg_t& backing)
+  : sz(size), host_base(nullptr), map_base(nullptr), map_len(0),
+    shared(backing.shm || backing.shared)
 {
   if (size == 0 || size % PGSIZE != 0)
     throw std::runtime_error("memory size must be a positive multiple of 4 KiB");
+
+  if (backing.contiguous())
+    map_contiguous(backing);
+}
+
+// Transparent hugepages are only used for 2 MiB-aligned ranges
+static const size_t HUGEPAGE_SIZE = size_t(2) << 20;
+
+void mem_t::map_contiguous(const mem_backing_cfg_t& backing)
+{
+  // Reserve (but don't commit) the whole region up front, padded so that the
+  // guest-visible base can be hugepage-aligned.  Untouched pages read as zero
+  // and consume no host memory, just like the sparse representation.
+  map_len = sz + HUGEPAGE_SIZE;
+  map_base = mmap(nullptr, map_len, PROT_READ | PROT_WRITE,
+                  MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (map_base == MAP_FAILED) {
+    map_base = nullptr;
+    throw std::runtime_error(std::string("unable to map guest memory: ") + strerror(errno));
+  }
+  host_base = (char*)(((uintptr_t)map_base + HUGEPAGE_SIZE - 1) & ~uintptr_t(HUGEPAGE_SIZE - 1));
+
+  if (!backing.path.empty())
+    map_file(backing);
+
+  if (backing.hugepages) {
+#ifdef MADV_HUGEPAGE
+    if (madvise(host_base, sz, MADV_HUGEPAGE) != 0)
+      fprintf(stderr, "warning: madvise(MADV_HUGEPAGE) failed: %s\n", strerror(errno));
+#else
+    fprintf(stderr, "warning: transparent hugepages are not supported on this host\n");
+#endif
+  }
+
+  if (backing.numa_node) {
+#if defined(__linux__) && defined(SYS_mbind)
+    // The policy must be installed before any page is touched, since it only
+    // governs where pages are faulted in.
+    const unsigned long bits_per_word = 8 * sizeof(unsigned long);
+    unsigned node = *backing.numa_node;
+    std::vector<unsigned long> nodemask(node / bits_per_word + 1, 0);
+    nodemask[node / bits_per_word] |= 1UL << (node % bits_per_word);
+    if (syscall(SYS_mbind, host_base, sz, MPOL_BIND, nodemask.data(),
+                nodemask.size() * bits_per_word + 1, 0) != 0)
+      fprintf(stderr, "warning: unable to bind guest memory to NUMA node %u: %s\n",
+              node, strerror(errno));
+#else
+    fprintf(stderr, "warning: NUMA placement is not supported on this host\n");
+#endif
+  }
+}
+
+void mem_t::map_file(const mem_backing_cfg_t& backing)
+{
+  std::string path = backing.path;
+  if (backing.shm && path[0] != '/')
+    path = "/" + path;
+
+  int fd = backing.shm ? shm_open(path.c_str(), O_RDWR | O_CREAT, 0600)
+                       : open(path.c_str(), backing.shared ? O_RDWR : O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error("unable to open " + path + ": " + strerror(errno));
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    throw std::runtime_error("unable to stat " + path + ": " + strerror(errno));
+  }
+
+  // A fresh shm object is sized to the region so that every page is backed
+  reg_t file_size = st.st_size;
+  if (backing.shm && file_size < sz) {
+    if (ftruncate(fd, sz) != 0) {
+      close(fd);
+      throw std::runtime_error("unable to resize " + path + ": " + strerror(errno));
+    }
+    file_size = sz;
+  }
+
+  if (file_size > sz)
+    fprintf(stderr, "warning: only the first 0x%" PRIx64 " bytes of %s are mapped\n",
+            sz, path.c_str());
+
+  // Pages past the end of the file keep the anonymous zero-filled mapping,
+  // since touching them through a file mapping would raise SIGBUS.
+  size_t len = (std::min(file_size, sz) + PGSIZE - 1) & ~reg_t(PGSIZE - 1);
+  int flags = (backing.shm || backing.shared) ? MAP_SHARED : MAP_PRIVATE;
+  if (len && mmap(host_base, len, PROT_READ | PROT_WRITE, flags | MAP_FIXED, fd, 0) == MAP_FAILED) {
+    close(fd);
+    throw std::runtime_error("unable to map " + path + ": " + strerror(errno));
+  }
+
+  close(fd);
 }
 
 mem_t::~mem_t()
 {
+  if (map_base)
+    munmap(map_base, map_len);
   for (auto& entry : sparse_memory_map)
     free(entry.second);
 }
@@ -114,6 +311,14 @@ bool mem_t::load_store(reg_t addr, size_t len, uint8_t* bytes, bool store)
   if (addr + len < addr || addr + len > sz)
     return false;
 
+  if (host_base) {
+    if (store)
+      memcpy(host_base + addr, bytes, len);
+    else
+      memcpy(bytes, host_base + addr, len);
+    return true;
+  }
+
   while (len > 0) {
     auto n = std::min(PGSIZE - (addr % PGSIZE), reg_t(len));
 
@@ -131,6 +336,9 @@ bool mem_t::load_store(reg_t addr, size_t len, uint8_t* bytes, bool store)
 }
 
 char* mem_t::contents(reg_t addr) {
+  if (host_base)
+    return host_base + addr;
+
   reg_t ppn = addr >> PGSHIFT, pgoff = addr % PGSIZE;
   auto search = sparse_memory_map.find(ppn);
   if (search == sparse_memory_map.end()) {
@@ -144,6 +352,11 @@ char* mem_t::contents(reg_t addr) {
 }
 
 void mem_t::dump(std::ostream& o) {
+  if (host_base) {
+    o.write(host_base, sz);
+    return;
+  }
+
   const char empty[PGSIZE] = {0};
   for (reg_t i = 0; i < sz; i += PGSIZE) {
     reg_t ppn = i >> PGSHIFT;
@@ -156,7 +369,45 @@ void mem_t::dump(std::ostream& o) {
   }
 }
 
-external_sim_device_t::external_sim_device_t(abstract_sim_if_t* sim) 
+static bool page_is_zero(const char* page)
+{
+  static const char zeros[PGSIZE] = {0};
+  return memcmp(page, zeros, PGSIZE) == 0;
+}
+
+void mem_t::save_image(int fd, uint64_t offset)
+{
+  if (host_base) {
+    for (reg_t addr = 0; addr < sz; addr += PGSIZE) {
+      if (!page_is_zero(host_base + addr))
+        checkpoint_pwrite(fd, host_base + addr, PGSIZE, offset + addr);
+    }
+    return;
+  }
+
+  for (auto& [ppn, page] : sparse_memory_map) {
+    if (!page_is_zero(page))
+      checkpoint_pwrite(fd, page, PGSIZE, offset + (ppn << PGSHIFT));
+  }
+}
+
+void mem_t::restore_image(int fd, uint64_t offset)
+{
+  // Map the image privately over the region, so each page is read from the
+  // checkpoint only when the guest first touches it, and guest stores never
+  // reach the file.  This replaces any host placement options.
+  if (!host_base) {
+    for (auto& entry : sparse_memory_map)
+      free(entry.second);
+    sparse_memory_map.clear();
+    map_contiguous(mem_backing_cfg_t());
+  }
+
+  if (mmap(host_base, sz, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, offset) == MAP_FAILED)
+    throw std::runtime_error(std::string("unable to map checkpoint: ") + strerror(errno));
+}
+
+external_sim_device_t::external_sim_device_t(abstract_sim_if_t* sim)
   : external_simulator(sim) {}
 
 void external_sim_device_t::set_simulator(abstract_sim_if_t* sim) {
@@ -2,10 +2,13 @@
 #define _RISCV_DEVICES_H
 
 #include "decode.h"
+#include "cfg.h"
 #include "abstract_device.h"
 #include "abstract_interrupt_controller.h"
 #include "platform.h"
+#include <deque>
 #include <map>
+#include <memory>
 #include <queue>
 #include <vector>
 #include <utility>
@@ -29,8 +32,45 @@ class bus_t : public abstract_device_t {
   std::pair<reg_t, abstract_device_t*> find_device(reg_t addr, size_t len);
 
  private:
+  // The dispatch table is a radix tree over physical page numbers.  A slot
+  // either maps its whole (aligned, power-of-2) span of pages to one device,
+  // or to no device, or refers to a finer-grained child node.  Pages that
+  // are only partly covered by a device are marked ambiguous and resolved
+  // through the devices map instead.
+  static const unsigned DISPATCH_LEVELS = 7;
+  static const unsigned DISPATCH_BITS = 8; // DISPATCH_LEVELS * DISPATCH_BITS + PGSHIFT >= 64
+
+  struct dispatch_target_t {
+    reg_t base;
+    reg_t size;
+    abstract_device_t* dev;
+  };
+
+  // A slot is a single word: null for no device, a dispatch_target_t*,
+  // a dispatch_node_t* tagged with DISPATCH_CHILD, or DISPATCH_AMBIGUOUS.
+  typedef uintptr_t dispatch_slot_t;
+  static const dispatch_slot_t DISPATCH_CHILD = 1;
+  static const dispatch_slot_t DISPATCH_AMBIGUOUS = 2;
+
+  struct dispatch_node_t {
+    dispatch_slot_t slots[reg_t(1) << DISPATCH_BITS] = {};
+  };
+
+  void dispatch_insert(dispatch_node_t* node, unsigned level, reg_t node_first_page,
+                       reg_t first_page, reg_t last_page,
+                       const dispatch_target_t* target);
+  std::pair<reg_t, abstract_device_t*> find_device_slow(reg_t addr, size_t len);
+
   std::map<reg_t, abstract_device_t*> devices;
   abstract_device_t* fallback;
+  dispatch_node_t* dispatch_root;
+  std::vector<std::unique_ptr<dispatch_node_t>> dispatch_nodes;
+  std::deque<dispatch_target_t> dispatch_targets;
+
+  // one-entry cache of the last device that fully contained an access
+  reg_t last_base;
+  reg_t last_size;
+  abstract_device_t* last_dev;
 };
 
 class rom_device_t : public abstract_device_t {
@@ -39,6 +79,7 @@ class rom_device_t : public abstract_device_t {
   bool load(reg_t addr, size_t len, uint8_t* bytes) override;
   bool store(reg_t addr, size_t len, const uint8_t* bytes) override;
   reg_t size() override { return data.size(); }
+  char* host_span(reg_t addr, bool write) override;
   const std::vector<char>& contents() { return data; }
  private:
   std::vector<char> data;
@@ -50,11 +91,22 @@ class abstract_mem_t : public abstract_device_t {
 
   virtual char* contents(reg_t addr) = 0;
   virtual void dump(std::ostream& o) = 0;
+
+  // Write the contents to fd at offset, a multiple of CHECKPOINT_ALIGN,
+  // leaving holes for pages of zeros; and map such an image back in.
+  virtual void save_image(int UNUSED fd, uint64_t UNUSED offset) {
+    throw std::runtime_error("checkpoints are not supported for this memory");
+  }
+  virtual void restore_image(int UNUSED fd, uint64_t UNUSED offset) {
+    throw std::runtime_error("checkpoints are not supported for this memory");
+  }
+
+  char* host_span(reg_t addr, bool UNUSED write) override { return contents(addr); }
 };
 
 class mem_t : public abstract_mem_t {
  public:
-  mem_t(reg_t size);
+  mem_t(reg_t size, const mem_backing_cfg_t& backing = {});
   mem_t(const mem_t& that) = delete;
   ~mem_t() override;
 
@@ -63,12 +115,26 @@ class mem_t : public abstract_mem_t {
   char* contents(reg_t addr) override;
   reg_t size() override { return sz; }
   void dump(std::ostream& o) override;
+  void save_image(int fd, uint64_t offset) override;
+  void restore_image(int fd, uint64_t offset) override;
+
+  // whether guest stores reach a mapping other processes can see
+  bool is_shared() const { return shared; }
 
  private:
   bool load_store(reg_t addr, size_t len, uint8_t* bytes, bool store);
+  void map_contiguous(const mem_backing_cfg_t& backing);
+  void map_file(const mem_backing_cfg_t& backing);
 
   std::map<reg_t, char*> sparse_memory_map;
   reg_t sz;
+
+  // If non-null, the whole region is one host mapping of map_len bytes
+  // starting at map_base, and sparse_memory_map is unused.
+  char* host_base;
+  void* map_base;
+  size_t map_len;
+  bool shared;
 };
 
 class abstract_sim_if_t {
@@ -99,6 +165,8 @@ class clint_t : public abstract_device_t {
   void tick(reg_t rtc_ticks) override;
   uint64_t get_mtimecmp(reg_t hartid) { return mtimecmp[hartid]; }
   uint64_t get_mtime() { return mtime; }
+  void save(checkpoint_buf_t& buf) override;
+  void restore(checkpoint_buf_t& buf) override;
  private:
   typedef uint64_t mtime_t;
   typedef uint64_t mtimecmp_t;
@@ -136,6 +204,8 @@ class plic_t : public abstract_device_t, public abstract_interrupt_controller_t
   bool store(reg_t addr, size_t len, const uint8_t* bytes) override;
   void set_interrupt_level(uint32_t id, int lvl) override;
   reg_t size() override { return PLIC_SIZE; }
+  void save(checkpoint_buf_t& buf) override;
+  void restore(checkpoint_buf_t& buf) override;
  private:
   std::vector<plic_context_t> contexts;
   uint32_t num_ids;
@@ -167,6 +237,8 @@ class ns16550_t : public abstract_device_t {
   bool store(reg_t addr, size_t len, const uint8_t* bytes) override;
   void tick(reg_t rtc_ticks) override;
   reg_t size() override { return NS16550_SIZE; }
+  void save(checkpoint_buf_t& buf) override;
+  void restore(checkpoint_buf_t& buf) override;
  private:
   abstract_interrupt_controller_t *intctrl;
   uint32_t interrupt_id;
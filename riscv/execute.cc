@@ -4,8 +4,10 @@
 #include "processor.h"
 #include "mmu.h"
 #include "disasm.h"
+#include "commit_log.h"
 #include "decode_macros.h"
 #include <cassert>
+#include <algorithm>
 
 static void commit_log_reset(processor_t* p)
 {
@@ -22,138 +24,87 @@ static void commit_log_stash_privilege(processor_t* p)
   state->last_inst_flen = p->get_flen();
 }
 
-static void commit_log_print_value(FILE *log_file, int width, const void *data)
+// Serializes the instruction's commit log record (see commit_log.h) through
+// write(data, len).
+template<typename WRITE>
+static void commit_log_write_insn(processor_t *p, reg_t pc, insn_t insn, WRITE write)
 {
-  assert(log_file);
-
-  switch (width) {
-    case 8:
-      fprintf(log_file, "0x%02" PRIx8, *(const uint8_t *)data);
-      break;
-    case 16:
-      fprintf(log_file, "0x%04" PRIx16, *(const uint16_t *)data);
-      break;
-    case 32:
-      fprintf(log_file, "0x%08" PRIx32, *(const uint32_t *)data);
-      break;
-    case 64:
-      fprintf(log_file, "0x%016" PRIx64, *(const uint64_t *)data);
-      break;
-    default:
-      if (width % 8 == 0) {
-        const uint8_t *arr = (const uint8_t *)data;
-
-        fprintf(log_file, "0x");
-        for (int idx = width / 8 - 1; idx >= 0; --idx) {
-          fprintf(log_file, "%02" PRIx8, arr[idx]);
-        }
-      } else {
-        abort();
-      }
-      break;
-  }
-}
-
-static void commit_log_print_value(FILE *log_file, int width, uint64_t val)
-{
-  commit_log_print_value(log_file, width, &val);
-}
-
-static void commit_log_print_insn(processor_t *p, reg_t pc, insn_t insn)
-{
-  FILE *log_file = p->get_log_file();
-
   auto& reg = p->get_state()->log_reg_write;
   auto& load = p->get_state()->log_mem_read;
   auto& store = p->get_state()->log_mem_write;
-  int priv = p->get_state()->last_inst_priv;
-  int xlen = p->get_state()->last_inst_xlen;
-  int flen = p->get_state()->last_inst_flen;
-
-  // print core id on all lines so it is easy to grep
-  fprintf(log_file, "core%4" PRId32 ": ", p->get_id());
-
-  fprintf(log_file, "%1d ", priv);
-  commit_log_print_value(log_file, xlen, pc);
-  fprintf(log_file, " (");
-  commit_log_print_value(log_file, insn.length() * 8, insn.bits());
-  fprintf(log_file, ")");
-  bool show_vec = false;
+  const reg_t vlen_bytes = p->VU.VLEN / 8;
+
+  commit_log_rec_t rec = {};
+  rec.pc = pc;
+  rec.insn = insn.bits();
+  rec.hartid = p->get_id();
+  rec.priv = p->get_state()->last_inst_priv;
+  rec.xlen = p->get_state()->last_inst_xlen;
+  rec.flen = p->get_state()->last_inst_flen;
+  rec.insn_length = insn.length();
+  rec.nloads = load.size();
+  rec.nstores = store.size();
+  rec.size = sizeof(rec) + rec.nloads * sizeof(uint64_t) +
+             rec.nstores * sizeof(commit_log_rec_store_t);
+
+  // registers are logged in the order of their keys, not of their writes
+  std::sort(reg.begin(), reg.end(), [](const auto& a, const auto& b) {
+    return a.first < b.first;
+  });
 
   for (auto item : reg) {
     if (item.first == 0)
       continue;
+    rec.nregs++;
+    rec.size += sizeof(commit_log_rec_reg_t);
+    if ((item.first & 0xf) == 2)
+      rec.size += vlen_bytes;
+  }
 
-    char prefix = ' ';
-    int size;
-    int rd = item.first >> 4;
-    bool is_vec = false;
-    bool is_vreg = false;
-    switch (item.first & 0xf) {
-    case 0:
-      size = xlen;
-      prefix = 'x';
-      break;
-    case 1:
-      size = flen;
-      prefix = 'f';
-      break;
-    case 2:
-      size = p->VU.VLEN;
-      prefix = 'v';
-      is_vreg = true;
-      break;
-    case 3:
-      is_vec = true;
-      break;
-    case 4:
-      size = xlen;
-      prefix = 'c';
-      break;
-    default:
-      assert("can't been here" && 0);
-      break;
-    }
+  if (p->any_vector_extensions()) {
+    rec.vsew = p->VU.vsew;
+    rec.vflmul = p->VU.vflmul;
+    rec.vl = p->VU.vl->read();
+  }
 
-    if (!show_vec && (is_vreg || is_vec)) {
-        fprintf(log_file, " e%ld %s%ld l%ld",
-                (long)p->VU.vsew,
-                p->VU.vflmul < 1 ? "mf" : "m",
-                p->VU.vflmul < 1 ? (long)(1 / p->VU.vflmul) : (long)p->VU.vflmul,
-                (long)p->VU.vl->read());
-        show_vec = true;
-    }
+  write(&rec, sizeof(rec));
 
-    if (!is_vec) {
-      if (prefix == 'c')
-        fprintf(log_file, " c%d_%s ", rd, csr_name(rd));
-      else
-        fprintf(log_file, " %c%-2d ", prefix, rd);
-      if (is_vreg)
-        commit_log_print_value(log_file, size, &p->VU.elt<uint8_t>(rd, 0));
-      else
-        commit_log_print_value(log_file, size, item.second.v);
-    }
+  for (auto item : reg) {
+    if (item.first == 0)
+      continue;
+    commit_log_rec_reg_t entry = {item.first, {item.second.v[0], item.second.v[1]}};
+    write(&entry, sizeof(entry));
+    if ((item.first & 0xf) == 2)
+      write(&p->VU.elt<uint8_t>(item.first >> 4, 0), vlen_bytes);
   }
 
   for (auto item : load) {
-    fprintf(log_file, " mem ");
-    commit_log_print_value(log_file, xlen, std::get<0>(item));
+    uint64_t addr = std::get<0>(item);
+    write(&addr, sizeof(addr));
   }
 
   for (auto item : store) {
-    fprintf(log_file, " mem ");
-    commit_log_print_value(log_file, xlen, std::get<0>(item));
-    fprintf(log_file, " ");
-    commit_log_print_value(log_file, std::get<2>(item) << 3, std::get<1>(item));
+    commit_log_rec_store_t entry = {std::get<0>(item), std::get<1>(item), std::get<2>(item)};
+    write(&entry, sizeof(entry));
   }
-  fprintf(log_file, "\n");
 }
 
-inline void processor_t::update_histogram(reg_t pc)
+static void commit_log_print_insn(processor_t *p, reg_t pc, insn_t insn)
 {
-  if (histogram_enabled)
-    pc_histogram[pc]++;
+  if (commit_log_writer_t *writer = p->get_log_commits_writer()) {
+    commit_log_write_insn(p, pc, insn, [writer](const void *data, size_t len) {
+      writer->write(data, len);
+    });
+    writer->commit();
+    return;
+  }
+
+  std::vector<char>& buf = p->get_state()->log_record;
+  buf.clear();
+  commit_log_write_insn(p, pc, insn, [&buf](const void *data, size_t len) {
+    buf.insert(buf.end(), (const char *)data, (const char *)data + len);
+  });
+  commit_log_print_text(p->get_log_file(), (const commit_log_rec_t *)buf.data(), p->VU.VLEN);
 }
 
 // These two functions are expected to be inlined by the compiler separately in
@@ -196,15 +147,54 @@ static inline reg_t execute_insn_logged(processor_t* p, reg_t pc, insn_fetch_t f
   } catch(...) {
     throw;
   }
-  p->update_histogram(pc);
 
   return npc;
 }
 
+// Applies the --log-commits filters to the step() iteration that starts at
+// pc. The iteration's limit is cut short where the instruction window starts
+// or ends, and if only the pc range keeps this code from being logged, the
+// fast path must stop once pc enters [watch_lo, watch_lo + watch_span).
+void processor_t::filter_log_commits(reg_t pc, size_t& limit, reg_t& watch_lo, reg_t& watch_span)
+{
+  const commit_log_filter_t& filter = log_commits_filter;
+  bool enable = (filter.priv_mask >> state.prv) & 1;
+
+  if (filter.window) {
+    reg_t start = filter.window->first;
+    reg_t end = start + std::min(filter.window->second, ~start);
+    if (retired_insns < start) {
+      enable = false;
+      limit = std::min<reg_t>(limit, start - retired_insns);
+    } else if (retired_insns < end) {
+      limit = std::min<reg_t>(limit, end - retired_insns);
+    } else {
+      enable = false;
+    }
+  }
+
+  bool watch = enable && !filter.in_pc_range(pc);
+  if (watch) {
+    enable = false;
+    watch_lo = filter.pc_range->first;
+    watch_span = filter.pc_range->second - watch_lo;
+    // The fast path only checks pc when it misses in the icache, so it
+    // mustn't hold the instruction that the range starts with.
+    if (!log_commits_watching)
+      mmu->flush_icache();
+  }
+  log_commits_watching = watch;
+
+  if (enable != log_commits_enabled) {
+    log_commits_enabled = enable;
+    mmu->flush_tlb(); // the TLB and the decoded instructions depend on it
+  }
+}
+
 bool processor_t::slow_path() const
 {
   return debug || state.single_step != state.STEP_NONE || state.debug_mode ||
-         log_commits_enabled || histogram_enabled || in_wfi || check_triggers_icount;
+         log_commits_enabled || in_wfi;
 }
 
 // fetch/decode/execute loop
@@ -223,11 +213,24 @@ void processor_t::step(size_t n)
 
   while (n > 0) {
     size_t instret = 0;
+    size_t limit = n;
     reg_t pc = state.pc;
     mmu_t* _mmu = mmu;
     state.prv_changed = false;
     state.v_changed = false;
 
+    // While an icount trigger is armed, instructions that can't make it
+    // fire run on the fast path and are counted in bulk afterwards. CSR
+    // instructions end the run before they execute (validate_csr() asks
+    // for PC_SERIALIZE_BEFORE), so tdata reads and writes always see a
+    // trigger that is up to date.
+    bool icount_skipping = false;
+    bool icount_skip_serialized = state.serialized;
+    size_t icount_unretired = 0;
+
+    // The pc range the commit log filters start logging at
+    reg_t log_watch_lo = 0, log_watch_span = 0;
+
     #define advance_pc() \
       if (unlikely(invalid_pc(pc))) { \
         switch (pc) { \
@@ -242,17 +245,52 @@ void processor_t::step(size_t n)
         instret++; \
       }
 
+    // Called before advance_pc(): a fall-through, or a branch to the next
+    // instruction, stays in the basic block.
+    #define bbv_transfer() (!invalid_pc(pc) && pc - state.pc - 1 >= 4)
+    #define check_bbv_transfer() \
+      if (unlikely(bbv_profile != nullptr) && bbv_transfer()) \
+        enter_bbv_block(pc, retired_insns + instret + 1);
+
     try
     {
       take_pending_interrupt();
 
       check_if_lpad_required();
 
-      if (unlikely(slow_path()))
+      if (unlikely(sample_profile != nullptr))
+        limit = std::min<reg_t>(limit, sample_countdown);
+      if (unlikely(bbv_profile != nullptr))
+        limit = std::min<reg_t>(limit, bbv_countdown);
+
+      if (unlikely(log_commits_filtered))
+        filter_log_commits(pc, limit, log_watch_lo, log_watch_span);
+
+      const bool bbv_enabled = bbv_profile != nullptr;
+      bool slow = slow_path();
+      if (!slow && unlikely(check_triggers_icount)) {
+        reg_t skip = TM.icount_skip_limit();
+        if (skip == 0) {
+          // The next instruction sets or fires an icount trigger
+          slow = true;
+          limit = 1;
+        } else {
+          icount_skipping = true;
+          limit = std::min<reg_t>(limit, skip);
+        }
+      }
+
+      if (unlikely(slow))
       {
         // Main simulation loop, slow path.
-        while (instret < n)
+        while (instret < limit)
         {
+          // Re-apply the commit log filters when pc crosses the logged range
+          if (unlikely(log_commits_filtered) &&
+              (pc - log_watch_lo < log_watch_span ||
+               (log_commits_enabled && !log_commits_filter.in_pc_range(pc))))
+            break;
+
           if (unlikely(!state.serialized && state.single_step == state.STEP_STEPPED)) {
             state.single_step = state.STEP_NONE;
             if (!state.debug_mode) {
@@ -284,6 +322,7 @@ void processor_t::step(size_t n)
           if (debug && !state.serialized)
             disasm(fetch.insn);
           pc = execute_insn_logged(this, pc, fetch);
+          check_bbv_transfer();
           advance_pc();
 
           // Resume from debug mode in critical error
@@ -298,26 +337,34 @@ void processor_t::step(size_t n)
           }
         }
       }
-      else while (instret < n)
+      else while (instret < limit)
       {
         // Main simulation loop, fast path.
+        if (unlikely(pc - log_watch_lo < log_watch_span))
+          break;
+
         for (auto ic_entry = _mmu->access_icache(pc); ; ) {
           auto fetch = ic_entry->data;
           pc = execute_insn_fast(this, pc, fetch);
           ic_entry = ic_entry->next;
           if (unlikely(ic_entry->tag != pc))
             break;
-          if (unlikely(instret + 1 == n))
+          // A branch can land on the entry the chain would fall through to
+          if (unlikely(bbv_enabled) && bbv_transfer())
+            break;
+          if (unlikely(instret + 1 == limit))
             break;
           instret++;
           state.pc = pc;
         }
 
+        check_bbv_transfer();
         advance_pc();
       }
     }
     catch(trap_t& t)
     {
+      icount_unretired = 1;
       take_trap(t, pc);
       n = instret;
 
@@ -342,10 +389,12 @@ void processor_t::step(size_t n)
     }
     catch (triggers::matched_t& t)
     {
+      icount_unretired = 1;
       take_trigger_action(t.action, t.address, pc, t.gva);
     }
     catch(trap_debug_mode&)
     {
+      icount_unretired = 1;
       enter_debug_mode(DCSR_CAUSE_SWBP, 0);
     }
     catch (wait_for_interrupt_t &t)
@@ -360,6 +409,39 @@ void processor_t::step(size_t n)
       in_wfi = true;
     }
 
+    if (icount_skipping) {
+      // The slow path would have counted every instruction it started,
+      // including one that trapped or must be replayed serialized, but
+      // not the replay itself.
+      if (state.serialized)
+        icount_unretired = 1;
+      TM.icount_skip(instret + icount_unretired - icount_skip_serialized);
+    }
+
+    if (unlikely(sample_profile != nullptr)) {
+      if (instret < sample_countdown) {
+        sample_countdown -= instret;
+      } else {
+        take_sample();
+        sample_countdown = sample_profile->get_period();
+      }
+    }
+
+    if (unlikely(bbv_profile != nullptr)) {
+      // a trap or debug mode entry redirected the hart
+      if (pc != state.pc)
+        enter_bbv_block(state.pc, retired_insns + instret);
+
+      if (instret < bbv_countdown) {
+        bbv_countdown -= instret;
+      } else {
+        enter_bbv_block(bbv_block_pc, retired_insns + instret);
+        bbv_profile->end_interval();
+        bbv_countdown = bbv_profile->get_interval();
+      }
+    }
+
+    retired_insns += instret;
     state.minstret->bump((state.mcountinhibit->read() & MCOUNTINHIBIT_IR) ? 0 : instret);
 
     // Model a hart whose CPI is 1.
@@ -0,0 +1,220 @@
+// See LICENSE for license details.
+
+#ifndef _RISCV_HOST_FPU_H
+#define _RISCV_HOST_FPU_H
+
+// Host-FPU fast paths for F and D arithmetic.
+//
+// The host's float and double arithmetic is used only when its result is
+// guaranteed to be bit-identical to softfloat's: round-to-nearest-even,
+// operands that are normal numbers or zeros, and a result that is a normal
+// number (not in the smallest binade, where tininess detection differs
+// between hosts) or an exact zero. Under those conditions inexact is the
+// only exception that can be raised, and it is read back from the host's
+// floating-point environment. In every other case -- NaNs, infinities,
+// subnormals, overflow, underflow, other rounding modes -- the host_*
+// functions return false and the caller falls back to softfloat.
+
+#include <cfenv>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include "softfloat.h"
+
+#if FLT_EVAL_METHOD == 0 && defined(FE_INEXACT)
+#define HOST_FPU_SUPPORTED \
+  (std::numeric_limits<float>::is_iec559 && std::numeric_limits<double>::is_iec559)
+#else
+#define HOST_FPU_SUPPORTED false
+#endif
+
+template<typename F> struct host_fpu_format;
+
+template<> struct host_fpu_format<float32_t>
+{
+  typedef float host_t;
+  static const int sig_bits = 23;
+  static const uint64_t exp_mask = 0xff;
+};
+
+template<> struct host_fpu_format<float64_t>
+{
+  typedef double host_t;
+  static const int sig_bits = 52;
+  static const uint64_t exp_mask = 0x7ff;
+};
+
+template<typename F>
+static inline uint64_t host_fpu_exp(F x)
+{
+  return (x.v >> host_fpu_format<F>::sig_bits) & host_fpu_format<F>::exp_mask;
+}
+
+template<typename F>
+static inline bool host_fpu_is_zero(F x)
+{
+  return (decltype(x.v))(x.v << 1) == 0;
+}
+
+// normal numbers and signed zeros
+template<typename F>
+static inline bool host_fpu_operand_ok(F x)
+{
+  uint64_t exp = host_fpu_exp(x);
+  return (exp != 0 && exp != host_fpu_format<F>::exp_mask) || host_fpu_is_zero(x);
+}
+
+template<typename F>
+static inline typename host_fpu_format<F>::host_t host_fpu_to_host(F x)
+{
+  typename host_fpu_format<F>::host_t h;
+  memcpy(&h, &x.v, sizeof(h));
+  return h;
+}
+
+// whether a host result matches softfloat's, given whether it was inexact
+template<typename F>
+static inline bool host_fpu_result_ok(F val, bool inexact)
+{
+  uint64_t exp = host_fpu_exp(val);
+  return inexact ? exp > 1 && exp != host_fpu_format<F>::exp_mask
+                 : host_fpu_operand_ok(val);
+}
+
+template<typename F>
+static inline F host_fpu_from_host(typename host_fpu_format<F>::host_t h)
+{
+  F x;
+  memcpy(&x.v, &h, sizeof(h));
+  return x;
+}
+
+template<typename F, typename OP>
+static inline bool host_fpu_compute(F& res, OP op)
+{
+  typedef typename host_fpu_format<F>::host_t host_t;
+
+  // the volatile result keeps the operation between the flag accesses
+  feclearexcept(FE_INEXACT);
+  volatile host_t host_res = op();
+  const bool inexact = fetestexcept(FE_INEXACT);
+
+  F val = host_fpu_from_host<F>(host_res);
+  if (!host_fpu_result_ok(val, inexact))
+    return false;
+
+  if (inexact)
+    softfloat_exceptionFlags |= softfloat_flag_inexact;
+  res = val;
+  return true;
+}
+
+#define HOST_FPU_BINARY_OP(name, F, expr) \
+  static inline bool host_##name(F& res, F a, F b) \
+  { \
+    if (!host_fpu_operand_ok(a) || !host_fpu_operand_ok(b)) \
+      return false; \
+    volatile typename host_fpu_format<F>::host_t x = host_fpu_to_host(a); \
+    volatile typename host_fpu_format<F>::host_t y = host_fpu_to_host(b); \
+    return host_fpu_compute(res, [&] { return expr; }); \
+  }
+
+HOST_FPU_BINARY_OP(f32_add, float32_t, x + y)
+HOST_FPU_BINARY_OP(f32_sub, float32_t, x - y)
+HOST_FPU_BINARY_OP(f32_mul, float32_t, x * y)
+HOST_FPU_BINARY_OP(f32_div, float32_t, x / y)
+HOST_FPU_BINARY_OP(f64_add, float64_t, x + y)
+HOST_FPU_BINARY_OP(f64_sub, float64_t, x - y)
+HOST_FPU_BINARY_OP(f64_mul, float64_t, x * y)
+HOST_FPU_BINARY_OP(f64_div, float64_t, x / y)
+
+#undef HOST_FPU_BINARY_OP
+
+template<typename F>
+static inline bool host_fpu_sqrt(F& res, F a)
+{
+  if (!host_fpu_operand_ok(a))
+    return false;
+  volatile typename host_fpu_format<F>::host_t x = host_fpu_to_host(a);
+  return host_fpu_compute(res, [&] { return std::sqrt(x); });
+}
+
+template<typename F>
+static inline bool host_fpu_mulAdd(F& res, F a, F b, F c)
+{
+  if (!host_fpu_operand_ok(a) || !host_fpu_operand_ok(b) || !host_fpu_operand_ok(c))
+    return false;
+  volatile typename host_fpu_format<F>::host_t x = host_fpu_to_host(a);
+  volatile typename host_fpu_format<F>::host_t y = host_fpu_to_host(b);
+  volatile typename host_fpu_format<F>::host_t z = host_fpu_to_host(c);
+  return host_fpu_compute(res, [&] { return std::fma(x, y, z); });
+}
+
+static inline bool host_f32_sqrt(float32_t& res, float32_t a) { return host_fpu_sqrt(res, a); }
+static inline bool host_f64_sqrt(float64_t& res, float64_t a) { return host_fpu_sqrt(res, a); }
+static inline bool host_f32_mulAdd(float32_t& res, float32_t a, float32_t b, float32_t c) { return host_fpu_mulAdd(res, a, b, c); }
+static inline bool host_f64_mulAdd(float64_t& res, float64_t a, float64_t b, float64_t c) { return host_fpu_mulAdd(res, a, b, c); }
+
+// op(args...) computed on the host FPU when enabled and exact-compatible,
+// otherwise by softfloat. softfloat_roundingMode must already be set.
+template<typename F, typename... Args>
+static inline F host_fpu_or_softfloat(bool enabled, bool (*host_op)(F&, Args...),
+                                      F (*soft_op)(Args...), Args... args)
+{
+  F res;
+  if (HOST_FPU_SUPPORTED && enabled &&
+      softfloat_roundingMode == softfloat_round_near_even && host_op(res, args...))
+    return res;
+  return soft_op(args...);
+}
+
+#define HOST_FPU_OR_SOFTFLOAT(op, ...) \
+  host_fpu_or_softfloat(p->get_cfg().host_fpu, host_##op, op, __VA_ARGS__)
+
+// Batched form for vector instructions: vd[i] = op(i) for i < n, where
+// operands_ok(i) checks element i's operands with host_fpu_operand_ok,
+// host_op(i) computes it on the host and soft_op(i) with softfloat.
+// Elements are processed in chunks so that the host loop vectorizes, and
+// the inexact flag is read once per chunk. A chunk that doesn't meet the
+// exactness conditions above is recomputed with softfloat.
+template<typename F, typename OK, typename HOST, typename SOFT>
+static inline void host_fpu_batch(F* vd, size_t n, OK operands_ok, HOST host_op, SOFT soft_op)
+{
+  typedef typename host_fpu_format<F>::host_t host_t;
+  const size_t chunk = 32;
+  host_t out[chunk];
+
+  for (size_t base = 0; base < n; base += chunk) {
+    const size_t len = std::min(chunk, n - base);
+    bool ok = true;
+    for (size_t i = 0; i < len; ++i)
+      ok &= operands_ok(base + i);
+
+    bool inexact = false;
+    if (ok) {
+      feclearexcept(FE_INEXACT);
+      for (size_t i = 0; i < len; ++i)
+        out[i] = host_op(base + i);
+      // keep the host arithmetic ahead of the flag test
+      asm volatile("" : : "r"(out) : "memory");
+      inexact = fetestexcept(FE_INEXACT);
+
+      for (size_t i = 0; i < len; ++i)
+        ok &= host_fpu_result_ok(host_fpu_from_host<F>(out[i]), inexact);
+    }
+
+    if (ok) {
+      for (size_t i = 0; i < len; ++i)
+        vd[base + i] = host_fpu_from_host<F>(out[i]);
+      if (inexact)
+        softfloat_exceptionFlags |= softfloat_flag_inexact;
+    } else {
+      for (size_t i = 0; i < len; ++i)
+        vd[base + i] = soft_op(base + i);
+    }
+  }
+}
+
+#endif
@@ -23,6 +23,7 @@ if (STATE.dcsr->v && STATE.dcsr->prv == PRV_U)
 
 /* We're not in Debug Mode anymore. */
 STATE.debug_mode = false;
+MMU.flush_tlb(); // in_mprv() depends on debug_mode
 
 if (STATE.dcsr->step)
   STATE.single_step = STATE.STEP_STEPPING;
@@ -1,5 +1,5 @@
 require_either_extension('F', EXT_ZFINX);
 require_fp;
 softfloat_roundingMode = RM;
-WRITE_FRD_F(f32_add(FRS1_F, FRS2_F));
+WRITE_FRD_F(HOST_FPU_OR_SOFTFLOAT(f32_add, FRS1_F, FRS2_F));
 set_fp_exceptions;
@@ -5,8 +5,15 @@ reg_t vl = P.VU.vl->read();
 reg_t rs2_num = insn.rs2();
 require(P.VU.vstart->read() == 0);
 reg_t popcount = 0;
-for (reg_t i=P.VU.vstart->read(); i<vl; ++i) {
-  bool vs2_bit = P.VU.mask_elt(rs2_num, i);
-  popcount += vs2_bit && (insn.v_vm() || P.VU.mask_elt(0, i));
+if (VI_MASK_WORDS_ELIGIBLE) {
+  const uint64_t *v0_words = P.VU.mask_words(0);
+  const uint64_t *vs2_words = P.VU.mask_words(rs2_num);
+  for (reg_t w = 0; w * 64 < vl; ++w)
+    popcount += ::popcount(vs2_words[w] & VI_MASK_WORD_ACTIVE(w) & VI_MASK_WORD_RANGE(w, 0, vl));
+} else {
+  for (reg_t i=P.VU.vstart->read(); i<vl; ++i) {
+    bool vs2_bit = P.VU.mask_elt(rs2_num, i);
+    popcount += vs2_bit && (insn.v_vm() || P.VU.mask_elt(0, i));
+  }
 }
 WRITE_RD(popcount);
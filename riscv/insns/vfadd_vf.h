@@ -1,6 +1,7 @@
 // vfadd.vf vd, vs2, rs1
-VI_VFP_VF_LOOP
-({
+VI_VFP_VF_LOOP_HOST
+(rs1 + vs2,
+{
   vd = f16_add(rs1, vs2);
 },
 {
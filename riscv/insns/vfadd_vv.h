@@ -1,6 +1,7 @@
 // vfadd.vv vd, vs2, vs1
-VI_VFP_VV_LOOP
-({
+VI_VFP_VV_LOOP_HOST
+(vs1 + vs2,
+{
   vd = f16_add(vs1, vs2);
 },
 {
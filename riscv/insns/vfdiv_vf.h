@@ -1,6 +1,7 @@
 // vfdiv.vf vd, vs2, rs1
-VI_VFP_VF_LOOP
-({
+VI_VFP_VF_LOOP_HOST
+(vs2 / rs1,
+{
   vd = f16_div(vs2, rs1);
 },
 {
@@ -1,6 +1,7 @@
 // vfdiv.vv  vd, vs2, vs1
-VI_VFP_VV_LOOP
-({
+VI_VFP_VV_LOOP_HOST
+(vs2 / vs1,
+{
   vd = f16_div(vs2, vs1);
 },
 {
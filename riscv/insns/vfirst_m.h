@@ -5,12 +5,24 @@ reg_t vl = P.VU.vl->read();
 reg_t rs2_num = insn.rs2();
 require(P.VU.vstart->read() == 0);
 reg_t pos = -1;
-for (reg_t i=P.VU.vstart->read(); i < vl; ++i) {
-  VI_LOOP_ELEMENT_SKIP()
+if (VI_MASK_WORDS_ELIGIBLE) {
+  const uint64_t *v0_words = P.VU.mask_words(0);
+  const uint64_t *vs2_words = P.VU.mask_words(rs2_num);
+  for (reg_t w = 0; w * 64 < vl; ++w) {
+    uint64_t set = vs2_words[w] & VI_MASK_WORD_ACTIVE(w) & VI_MASK_WORD_RANGE(w, 0, vl);
+    if (set) {
+      pos = w * 64 + ctz(set);
+      break;
+    }
+  }
+} else {
+  for (reg_t i=P.VU.vstart->read(); i < vl; ++i) {
+    VI_LOOP_ELEMENT_SKIP()
 
-  if (P.VU.mask_elt(rs2_num, i)) {
-    pos = i;
-    break;
+    if (P.VU.mask_elt(rs2_num, i)) {
+      pos = i;
+      break;
+    }
   }
 }
 WRITE_RD(pos);
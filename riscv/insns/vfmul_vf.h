@@ -1,6 +1,7 @@
 // vfmul.vf vd, vs2, rs1, vm
-VI_VFP_VF_LOOP
-({
+VI_VFP_VF_LOOP_HOST
+(vs2 * rs1,
+{
   vd = f16_mul(vs2, rs1);
 },
 {
@@ -1,6 +1,7 @@
 // vfmul.vv vd, vs1, vs2, vm
-VI_VFP_VV_LOOP
-({
+VI_VFP_VV_LOOP_HOST
+(vs1 * vs2,
+{
   vd = f16_mul(vs1, vs2);
 },
 {
@@ -1,6 +1,7 @@
 // vfsub.vv vd, vs2, vs1
-VI_VFP_VV_LOOP
-({
+VI_VFP_VV_LOOP_HOST
+(vs2 - vs1,
+{
   vd = f16_sub(vs2, vs1);
 },
 {
@@ -284,6 +284,7 @@ void sim_t::interactive()
   funcs["untiln"] = &sim_t::interactive_until_noisy;
   funcs["while"] = &sim_t::interactive_until_silent;
   funcs["dump"] = &sim_t::interactive_dumpmems;
+  funcs["fork"] = &sim_t::interactive_fork;
   funcs["quit"] = &sim_t::interactive_quit;
   funcs["q"] = funcs["quit"];
   funcs["help"] = &sim_t::interactive_help;
@@ -372,6 +373,9 @@ void sim_t::interactive_help(const std::string& cmd, const std::vector<std::stri
     "mem [core] <hex addr>           # Show contents of virtual memory <hex addr> in [core] (physical memory <hex addr> if omitted)\n"
     "str [core] <hex addr>           # Show NUL-terminated C string at virtual address <hex addr> in [core] (physical address <hex addr> if omitted)\n"
     "dump                            # Dump physical memory to binary files\n"
+    "fork <config> [config...]       # Fork a child per <config> to run to completion, and wait for them\n"
+    "                                  (<config> is a comma-separated list of ic=, dc=, l2=<S>:<W>:<B>,\n"
+    "                                  out=<file> and load=<file>@<hex addr>)\n"
     "mtime                           # Show mtime\n"
     "mtimecmp <core>                 # Show mtimecmp for <core>\n"
     "until reg <core> <reg> <val>    # Stop when <reg> in <core> hits <val>\n"
@@ -820,6 +824,27 @@ void sim_t::interactive_dumpmems(const std::string& cmd, const std::vector<std::
   }
 }
 
+void sim_t::interactive_fork(const std::string& cmd, const std::vector<std::string>& args)
+{
+  if (args.empty())
+    throw trap_interactive();
+
+  std::ostream out(sout_.rdbuf());
+  int status;
+  try {
+    if (fork_children(args, &status)) {
+      // leave the prompt, and let the child run to completion
+      next_interactive_action = [](){};
+      return;
+    }
+  } catch (std::exception& e) {
+    out << "Unable to fork: " << e.what() << std::endl;
+    return;
+  }
+
+  out << "Children exited with status " << status << std::endl;
+}
+
 void sim_t::interactive_mtime(const std::string& cmd, const std::vector<std::string>& args)
 {
   std::ostream out(sout_.rdbuf());
@@ -49,6 +49,10 @@ class memtracer_list_t : public memtracer_t
   {
     list.push_back(h);
   }
+  void unhook_all()
+  {
+    list.clear();
+  }
  private:
   std::vector<memtracer_t*> list;
 };
@@ -6,15 +6,17 @@
 #include "simif.h"
 #include "processor.h"
 #include "decode_macros.h"
+#include <algorithm>
 
 mmu_t::mmu_t(simif_t* sim, endianness_t endianness, processor_t* proc, reg_t cache_blocksz)
  : sim(sim), proc(proc), blocksz(cache_blocksz),
+  misaligned_enabled(proc && proc->get_cfg().misaligned),
+  tlb_context(0),
+  pmp_map_valid(false),
 #ifdef RISCV_ENABLE_DUAL_ENDIAN
   target_big_endian(endianness == endianness_big),
 #endif
-  check_triggers_fetch(false),
-  check_triggers_load(false),
-  check_triggers_store(false)
+  trigger_ranges()
 {
 #ifndef RISCV_ENABLE_DUAL_ENDIAN
   assert(endianness == endianness_little);
@@ -42,6 +44,24 @@ void mmu_t::flush_tlb()
   flush_icache();
 }
 
+void mmu_t::set_tlb_privilege(reg_t prv, bool virt)
+{
+  // Entries filled while translation is off are identity mappings that
+  // depend only on the privilege mode and on PMP, mstatus and effective
+  // MPRV state (which debug mode and mnstatus.NMIE also gate), whose
+  // changes flush the TLB. Tagging entries with the privilege mode lets
+  // those survive trips through trap handlers. Entries for translated
+  // modes are dropped, as software may have changed the page tables
+  // without an sfence.vma that our TLB would observe.
+  tlb_context = ((prv << 1) | virt) << TLB_CONTEXT_SHIFT;
+
+  reg_t satp = proc->get_state()->satp->readvirt(virt);
+  if (virt || decode_vm_info(proc->get_const_xlen(), false, prv, satp).levels != 0)
+    flush_tlb();
+  else
+    flush_icache(); // I$ hits skip the PMP execute check
+}
+
 void throw_access_exception(bool virt, reg_t addr, access_type type)
 {
   switch (type) {
@@ -99,9 +119,9 @@ mmu_t::insn_parcel_t mmu_t::fetch_slow_path(reg_t vaddr)
 
   if (!tlb_hit) {
     paddr = translate(access_info, sizeof(insn_parcel_t));
-    host_addr = (uintptr_t)sim->addr_to_mem(paddr);
+    host_addr = (uintptr_t)sim->addr_to_host(paddr, FETCH);
 
-    refill_tlb(vaddr, paddr, (char*)host_addr, FETCH);
+    refill_tlb(access_info, paddr, (char*)host_addr);
   }
 
   auto res = perform_intrapage_fetch(vaddr, host_addr, paddr);
@@ -180,17 +200,60 @@ bool mmu_t::mmio(reg_t paddr, size_t len, uint8_t* bytes, access_type type)
       return sim->mmio_load(paddr, len, bytes);
   }
 
-  for (size_t i = 0; i < len; i++) {
-    if (!mmio(paddr + i, 1, bytes + i, type))
-      return false;
+  // Split the access into the largest naturally aligned pieces. Devices that
+  // accept only one access width, like ns16550 with a 1-byte reg_io_width,
+  // reject the wider pieces, which are then retried a byte at a time.
+  while (len > 0) {
+    size_t chunk = sizeof(reg_t);
+    while (chunk > len || (paddr & (chunk - 1)))
+      chunk >>= 1;
+
+    if (!mmio(paddr, chunk, bytes, type)) {
+      if (chunk == 1)
+        return false;
+      for (size_t i = 0; i < chunk; i++) {
+        if (!mmio(paddr + i, 1, bytes + i, type))
+          return false;
+      }
+    }
+
+    paddr += chunk;
+    bytes += chunk;
+    len -= chunk;
   }
 
   return true;
 }
 
+void mmu_t::set_trigger_ranges(triggers::operation_t operation, std::vector<std::pair<reg_t, reg_t>> ranges)
+{
+  std::sort(ranges.begin(), ranges.end());
+
+  auto& merged = trigger_ranges[operation];
+  merged.clear();
+  for (auto range : ranges) {
+    if (!merged.empty() && (merged.back().second == reg_t(-1) || range.first <= merged.back().second + 1))
+      merged.back().second = std::max(merged.back().second, range.second);
+    else
+      merged.push_back(range);
+  }
+}
+
+bool mmu_t::trigger_may_match(triggers::operation_t operation, reg_t lo, reg_t hi) const
+{
+  // RV32 harts compare only the low 32 bits of a possibly sign-extended
+  // address, so also try the range with the upper bits cleared
+  for (auto range : trigger_ranges[operation])
+    if ((range.first <= hi && lo <= range.second) ||
+        (range.first <= (hi & 0xffffffff) && (lo & 0xffffffff) <= range.second))
+      return true;
+
+  return false;
+}
+
 void mmu_t::check_triggers(triggers::operation_t operation, reg_t address, bool virt, reg_t tval, std::optional<reg_t> data)
 {
-  if (matched_trigger || !proc)
+  if (matched_trigger || !proc || !trigger_may_match(operation, address, address))
     return;
 
   auto match = proc->TM.detect_memory_access_match(operation, address, data);
@@ -231,10 +294,10 @@ void mmu_t::load_slow_path_intrapage(reg_t len, uint8_t* bytes, mem_access_info_
   auto [tlb_hit, host_addr, paddr] = access_tlb(tlb_load, vaddr, TLB_FLAGS);
   if (!tlb_hit || access_info.flags.is_special_access()) {
     paddr = translate(access_info, len);
-    host_addr = (uintptr_t)sim->addr_to_mem(paddr);
+    host_addr = (uintptr_t)sim->addr_to_host(paddr, LOAD);
 
     if (!access_info.flags.is_special_access())
-      refill_tlb(vaddr, paddr, (char*)host_addr, LOAD);
+      refill_tlb(access_info, paddr, (char*)host_addr);
 
     if (access_info.flags.lr && !sim->reservable(paddr)) {
       throw trap_load_access_fault(access_info.effective_virt, access_info.transformed_vaddr, 0, 0);
@@ -259,6 +322,17 @@ void mmu_t::load_slow_path(reg_t original_addr, reg_t len, uint8_t* bytes, xlate
     if (likely(tlb_hit && (aligned || (intrapage && is_misaligned_enabled())))) {
       return perform_intrapage_load(original_addr, host_addr, paddr, len, bytes, xlate_flags);
     }
+
+    // Misaligned access spanning two pages that are both in the TLB
+    if (tlb_hit && !intrapage && is_misaligned_enabled() && !xlate_flags.lr) {
+      reg_t len_page0 = PGSIZE - original_addr % PGSIZE;
+      auto [tlb_hit1, host_addr1, paddr1] = access_tlb(tlb_load, original_addr + len_page0, TLB_FLAGS & ~TLB_CHECK_TRIGGERS);
+      if (tlb_hit1) {
+        perform_intrapage_load(original_addr, host_addr, paddr, len_page0, bytes, xlate_flags);
+        perform_intrapage_load(original_addr + len_page0, host_addr1, paddr1, len - len_page0, bytes + len_page0, xlate_flags);
+        return;
+      }
+    }
   }
 
   auto access_info = generate_access_info(original_addr, LOAD, xlate_flags);
@@ -313,17 +387,17 @@ void mmu_t::store_slow_path_intrapage(reg_t len, const uint8_t* bytes, mem_acces
   auto [tlb_hit, host_addr, paddr] = access_tlb(tlb_store, vaddr, TLB_FLAGS);
   if (!tlb_hit || access_info.flags.is_special_access()) {
     paddr = translate(access_info, len);
-    host_addr = (uintptr_t)sim->addr_to_mem(paddr);
+    host_addr = (uintptr_t)sim->addr_to_host(paddr, STORE);
 
     if (!access_info.flags.is_special_access())
-      refill_tlb(vaddr, paddr, (char*)host_addr, STORE);
+      refill_tlb(access_info, paddr, (char*)host_addr);
   }
 
   if (actually_store)
     perform_intrapage_store(vaddr, host_addr, paddr, len, bytes, access_info.flags);
 }
 
-void mmu_t::store_slow_path(reg_t original_addr, reg_t len, const uint8_t* bytes, xlate_flags_t xlate_flags, bool actually_store, bool UNUSED require_alignment)
+void mmu_t::store_slow_path(reg_t original_addr, reg_t len, const uint8_t* bytes, xlate_flags_t xlate_flags, bool actually_store, bool require_alignment)
 {
   if (likely(!xlate_flags.is_special_access())) {
     // Fast path for simple cases
@@ -336,6 +410,17 @@ void mmu_t::store_slow_path(reg_t original_addr, reg_t len, const uint8_t* bytes
         perform_intrapage_store(original_addr, host_addr, paddr, len, bytes, xlate_flags);
       return;
     }
+
+    // Misaligned access spanning two pages that are both in the TLB
+    if (tlb_hit && !intrapage && is_misaligned_enabled() && actually_store && !require_alignment) {
+      reg_t len_page0 = PGSIZE - original_addr % PGSIZE;
+      auto [tlb_hit1, host_addr1, paddr1] = access_tlb(tlb_store, original_addr + len_page0, TLB_FLAGS & ~TLB_CHECK_TRIGGERS);
+      if (tlb_hit1) {
+        perform_intrapage_store(original_addr, host_addr, paddr, len_page0, bytes, xlate_flags);
+        perform_intrapage_store(original_addr + len_page0, host_addr1, paddr1, len - len_page0, bytes + len_page0, xlate_flags);
+        return;
+      }
+    }
   }
 
   auto access_info = generate_access_info(original_addr, STORE, xlate_flags);
@@ -373,10 +458,60 @@ void mmu_t::store_slow_path(reg_t original_addr, reg_t len, const uint8_t* bytes
     proc->state.log_mem_write.push_back(std::make_tuple(original_addr, reg_from_bytes(len, bytes), len));
 }
 
-tlb_entry_t mmu_t::refill_tlb(reg_t vaddr, reg_t paddr, char* host_addr, access_type type)
+// Whether every page touched by [addr, addr + len) hits in the TLB without
+// needing trigger checks, memtracer notification or MMIO. Memtracers such as
+// the cache models expect one call per element, so traced pages take the
+// per-element path.
+bool mmu_t::bulk_span_in_tlb(const dtlb_entry_t* tlb, reg_t addr, reg_t len)
+{
+  if (target_big_endian)
+    return false;
+
+  for (reg_t offset = 0; offset < len; offset += PGSIZE - (addr + offset) % PGSIZE) {
+    auto [tlb_hit, host_addr, _] = access_tlb(tlb, addr + offset);
+    if (!tlb_hit)
+      return false;
+  }
+
+  return true;
+}
+
+bool mmu_t::load_bulk(reg_t addr, reg_t len, uint8_t* bytes)
+{
+  if (!bulk_span_in_tlb(tlb_load, addr, len))
+    return false;
+
+  for (reg_t offset = 0; offset < len; ) {
+    reg_t chunk = std::min(len - offset, PGSIZE - (addr + offset) % PGSIZE);
+    auto [tlb_hit, host_addr, _] = access_tlb(tlb_load, addr + offset);
+    memcpy(bytes + offset, (const char*)host_addr, chunk);
+    offset += chunk;
+  }
+
+  return true;
+}
+
+bool mmu_t::store_bulk(reg_t addr, reg_t len, const uint8_t* bytes)
+{
+  if (!bulk_span_in_tlb(tlb_store, addr, len))
+    return false;
+
+  for (reg_t offset = 0; offset < len; ) {
+    reg_t chunk = std::min(len - offset, PGSIZE - (addr + offset) % PGSIZE);
+    auto [tlb_hit, host_addr, _] = access_tlb(tlb_store, addr + offset);
+    memcpy((char*)host_addr, bytes + offset, chunk);
+    offset += chunk;
+  }
+
+  return true;
+}
+
+tlb_entry_t mmu_t::refill_tlb(mem_access_info_t access_info, reg_t paddr, char* host_addr)
 {
+  reg_t vaddr = access_info.vaddr;
+  access_type type = access_info.type;
   reg_t idx = (vaddr >> PGSHIFT) % TLB_ENTRIES;
-  reg_t expected_tag = vaddr >> PGSHIFT;
+  reg_t expected_tag = (vaddr >> PGSHIFT) | tlb_context;
   reg_t base_paddr = paddr & ~reg_t(PGSIZE - 1);
 
   tlb_entry_t entry = {uintptr_t(host_addr) - (vaddr % PGSIZE), paddr - (vaddr % PGSIZE)};
@@ -389,18 +524,24 @@ tlb_entry_t mmu_t::refill_tlb(reg_t vaddr, reg_t paddr, char* host_addr, access_
   auto trace_flag = tracer.interested_in_range(base_paddr, base_paddr + PGSIZE, type) ? TLB_CHECK_TRACER : 0;
   auto mmio_flag = host_addr ? 0 : TLB_MMIO;
 
+  // Triggers compare the address after pointer masking
+  reg_t trigger_base = access_info.transformed_vaddr & ~reg_t(PGSIZE - 1);
+  auto trigger_flag = [&](triggers::operation_t operation) {
+    return trigger_may_match(operation, trigger_base, trigger_base + PGSIZE - 1) ? TLB_CHECK_TRIGGERS : 0;
+  };
+
   switch (type) {
     case FETCH:
       tlb_insn[idx].data = entry;
-      tlb_insn[idx].tag = expected_tag | (check_triggers_fetch ? TLB_CHECK_TRIGGERS : 0) | trace_flag | mmio_flag;
+      tlb_insn[idx].tag = expected_tag | trigger_flag(triggers::OPERATION_EXECUTE) | trace_flag | mmio_flag;
       break;
     case LOAD:
       tlb_load[idx].data = entry;
-      tlb_load[idx].tag = expected_tag | (check_triggers_load ? TLB_CHECK_TRIGGERS : 0) | trace_flag | mmio_flag;
+      tlb_load[idx].tag = expected_tag | trigger_flag(triggers::OPERATION_LOAD) | trace_flag | mmio_flag;
       break;
     case STORE:
       tlb_store[idx].data = entry;
-      tlb_store[idx].tag = expected_tag | (check_triggers_store ? TLB_CHECK_TRIGGERS : 0) | trace_flag | mmio_flag;
+      tlb_store[idx].tag = expected_tag | trigger_flag(triggers::OPERATION_STORE) | trace_flag | mmio_flag;
       break;
     default:
       abort();
@@ -409,30 +550,62 @@ tlb_entry_t mmu_t::refill_tlb(reg_t vaddr, reg_t paddr, char* host_addr, access_
   return entry;
 }
 
+void mmu_t::build_pmp_map()
+{
+  std::vector<reg_t> bounds = {0};
+  for (size_t i = 0; i < proc->n_pmp; i++) {
+    reg_t base, last;
+    if (proc->state.pmpaddr[i]->match_range(&base, &last)) {
+      bounds.push_back(base);
+      if (last + 1 != 0)
+        bounds.push_back(last + 1);
+    }
+  }
+  std::sort(bounds.begin(), bounds.end());
+  bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+
+  // No entry's match changes within a range, so its first address decides
+  pmp_map.clear();
+  for (reg_t base : bounds) {
+    int idx = -1;
+    for (size_t i = 0; i < proc->n_pmp && idx < 0; i++)
+      if (proc->state.pmpaddr[i]->match4(base))
+        idx = i;
+
+    if (pmp_map.empty() || pmp_map.back().idx != idx)
+      pmp_map.push_back({base, idx});
+  }
+
+  pmp_map_valid = true;
+}
+
+std::vector<mmu_t::pmp_range_t>::const_iterator mmu_t::pmp_range(reg_t addr)
+{
+  if (!pmp_map_valid)
+    build_pmp_map();
+
+  auto it = std::upper_bound(pmp_map.cbegin(), pmp_map.cend(), addr,
+    [](reg_t a, const pmp_range_t& r) { return a < r.base; });
+  return it - 1;
+}
+
 bool mmu_t::pmp_ok(reg_t addr, reg_t len, access_type type, reg_t mode, bool hlvx)
 {
   if (!proc || proc->n_pmp == 0)
     return true;
 
-  for (size_t i = 0; i < proc->n_pmp; i++) {
-    // Check each 4-byte sector of the access
-    bool any_match = false;
-    bool all_match = true;
-    for (reg_t offset = 0; offset < len; offset += 1 << PMP_SHIFT) {
-      reg_t cur_addr = addr + offset;
-      bool match = proc->state.pmpaddr[i]->match4(cur_addr);
-      any_match |= match;
-      all_match &= match;
-    }
+  // The access is checked one 4-byte sector at a time, starting at addr
+  auto range = pmp_range(addr);
+  auto next = range + 1;
+  reg_t last_sector = addr + ((len - 1) & -(reg_t(1) << PMP_SHIFT));
 
-    if (any_match) {
-      // If the PMP matches only a strict subset of the access, fail it
-      if (!all_match)
-        return false;
+  // Neighbouring ranges have different owners, so an access that spans
+  // two of them matches only a strict subset of some entry: fail it
+  if (next != pmp_map.cend() && next->base <= last_sector)
+    return false;
 
-      return proc->state.pmpaddr[i]->access_ok(type, mode, hlvx);
-    }
-  }
+  if (range->idx >= 0)
+    return proc->state.pmpaddr[range->idx]->access_ok(type, mode, hlvx);
 
   // in case matching region is not found
   const bool mseccfg_mml = proc->state.mseccfg->get_mml();
@@ -446,14 +619,11 @@ reg_t mmu_t::pmp_homogeneous(reg_t addr, reg_t len)
   if ((addr | len) & (len - 1))
     abort();
 
-  if (!proc)
+  if (!proc || proc->n_pmp == 0)
     return true;
 
-  for (size_t i = 0; i < proc->n_pmp; i++)
-    if (proc->state.pmpaddr[i]->subset_match(addr, len))
-      return false;
-
-  return true;
+  auto next = pmp_range(addr) + 1;
+  return next == pmp_map.cend() || next->base - addr >= len;
 }
 
 reg_t mmu_t::s2xlate(reg_t gva, reg_t gpa, access_type type, access_type trap_type, bool virt, bool hlvx, bool is_for_vs_pt_addr)
@@ -675,6 +845,12 @@ void mmu_t::register_memtracer(memtracer_t* t)
   tracer.hook(t);
 }
 
+void mmu_t::unregister_memtracers()
+{
+  flush_tlb();
+  tracer.unhook_all();
+}
+
 reg_t mmu_t::get_pmlen(bool effective_virt, reg_t effective_priv, xlate_flags_t flags) const {
   if (!proc || proc->get_xlen() != 64 || flags.hlvx)
     return 0;
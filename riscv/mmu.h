@@ -100,6 +100,8 @@ public:
 
     if (likely(!xlate_flags.is_special_access() && aligned && tlb_hit)) {
       res = *(target_endian<T>*)host_addr;
+    } else if (!xlate_flags.is_special_access() && tlb_hit && misaligned_intrapage(addr, sizeof(T))) {
+      memcpy(&res, (const void*)host_addr, sizeof(T));
     } else {
       load_slow_path(addr, sizeof(T), (uint8_t*)&res, xlate_flags);
     }
@@ -109,6 +111,19 @@ public:
     return from_target(res);
   }
 
+  // Reads guest memory through the load TLB alone, so without traps, trigger
+  // matches or tracer callbacks; for profilers inspecting the guest. Returns
+  // false if addr is misaligned or its translation isn't cached.
+  template<typename T>
+  bool peek(reg_t addr, T* value) {
+    auto [tlb_hit, host_addr, _] = access_tlb(tlb_load, addr);
+    if ((addr & (sizeof(T) - 1)) != 0 || !tlb_hit)
+      return false;
+
+    *value = from_target(*(target_endian<T>*)host_addr);
+    return true;
+  }
+
   template<typename T>
   T load_reserved(reg_t addr) {
     return load<T>(addr, {.lr = true});
@@ -140,6 +155,9 @@ public:
 
     if (!xlate_flags.is_special_access() && likely(aligned && tlb_hit)) {
       *(target_endian<T>*)host_addr = to_target(val);
+    } else if (!xlate_flags.is_special_access() && tlb_hit && misaligned_intrapage(addr, sizeof(T))) {
+      target_endian<T> target_val = to_target(val);
+      memcpy((void*)host_addr, &target_val, sizeof(T));
     } else {
       target_endian<T> target_val = to_target(val);
       store_slow_path(addr, sizeof(T), (const uint8_t*)&target_val, xlate_flags, true, false);
@@ -159,6 +177,15 @@ public:
     store<T>(addr, val, {.forced_virt=false, .hlvx=false, .lr=false, .ss_access=true});
   }
 
+  // copy a span of guest memory in one go, for bulk vector accesses.
+  // this succeeds only if every page of the span already hits in the TLB,
+  // is backed by host memory and is not traced; otherwise no access is
+  // performed and false is returned, so that the caller can fall back to
+  // per-element accesses that take the usual trap, trigger and memtracer
+  // paths.
+  bool load_bulk(reg_t addr, reg_t len, uint8_t* bytes);
+  bool store_bulk(reg_t addr, reg_t len, const uint8_t* bytes);
+
   // AMO/Zicbom faults should be reported as store faults
   #define convert_load_traps_to_store_traps(BODY) \
     try { \
@@ -365,7 +392,7 @@ public:
   {
     auto vpn = vaddr / PGSIZE, pgoff = vaddr % PGSIZE;
     auto& entry = tlb[vpn % TLB_ENTRIES];
-    auto hit = likely((entry.tag & (~allowed_flags | required_flags)) == (vpn | required_flags));
+    auto hit = likely((entry.tag & (~allowed_flags | required_flags)) == (vpn | tlb_context | required_flags));
     bool mmio = allowed_flags & TLB_MMIO & entry.tag;
     auto host_addr = mmio ? 0 : entry.data.host_addr + pgoff;
     auto paddr = entry.data.target_addr + pgoff;
@@ -374,12 +401,27 @@ public:
 
   void flush_tlb();
   void flush_icache();
+  // set the addresses that triggers for an operation might match; the
+  // caller must flush the TLB afterwards
+  void set_trigger_ranges(triggers::operation_t operation, std::vector<std::pair<reg_t, reg_t>> ranges);
+
+  // update the TLB for a change of privilege mode
+  void set_tlb_privilege(reg_t prv, bool virt);
+  // discard the PMP region map; call whenever pmpcfg/pmpaddr change
+  void flush_pmp() { pmp_map_valid = false; }
 
   void register_memtracer(memtracer_t*);
+  void unregister_memtracers();
 
   int is_misaligned_enabled()
   {
-    return proc && proc->get_cfg().misaligned;
+    return misaligned_enabled;
+  }
+
+  // whether a misaligned access can be completed within a single page
+  bool misaligned_intrapage(reg_t addr, reg_t len)
+  {
+    return misaligned_enabled && (addr % PGSIZE) + len <= PGSIZE;
   }
 
   bool is_target_big_endian()
@@ -403,6 +445,7 @@ private:
   memtracer_list_t tracer;
   reg_t load_reservation_address;
   reg_t blocksz;
+  const bool misaligned_enabled;
 
   // implement an instruction cache for simulator performance
   icache_entry_t icache[ICACHE_ENTRIES];
@@ -415,12 +458,31 @@ private:
   static const reg_t TLB_CHECK_TRACER = reg_t(1) << 62;
   static const reg_t TLB_MMIO = reg_t(1) << 61;
   static const reg_t TLB_FLAGS = TLB_CHECK_TRIGGERS | TLB_CHECK_TRACER | TLB_MMIO;
+  // Tags also carry the privilege mode and virtualization mode the entry
+  // was filled under, above the largest possible VPN.
+  static const int TLB_CONTEXT_SHIFT = 58;
+  reg_t tlb_context;
   dtlb_entry_t tlb_load[TLB_ENTRIES];
   dtlb_entry_t tlb_store[TLB_ENTRIES];
   dtlb_entry_t tlb_insn[TLB_ENTRIES];
 
+  // PMP entries flattened into sorted, non-overlapping address ranges,
+  // each tagged with the index of the highest-priority entry matching it
+  // (or -1 for none). A range extends up to the next range's base, and
+  // adjacent ranges always have different owners. Rebuilt lazily after
+  // flush_pmp(), so pmp_ok() is a binary search rather than a scan of
+  // every pmpaddr register.
+  struct pmp_range_t {
+    reg_t base;
+    int idx;
+  };
+  std::vector<pmp_range_t> pmp_map;
+  bool pmp_map_valid;
+  void build_pmp_map();
+  std::vector<pmp_range_t>::const_iterator pmp_range(reg_t addr);
+
   // finish translation on a TLB miss and update the TLB
-  tlb_entry_t refill_tlb(reg_t vaddr, reg_t paddr, char* host_addr, access_type type);
+  tlb_entry_t refill_tlb(mem_access_info_t access_info, reg_t paddr, char* host_addr);
   const char* fill_from_mmio(reg_t vaddr, reg_t paddr);
 
   // perform a stage2 translation for a given guest address
@@ -439,6 +501,7 @@ private:
   void store_slow_path(reg_t original_addr, reg_t len, const uint8_t* bytes, xlate_flags_t xlate_flags, bool actually_store, bool require_alignment);
   void store_slow_path_intrapage(reg_t len, const uint8_t* bytes, mem_access_info_t access_info, bool actually_store);
   void perform_intrapage_store(reg_t vaddr, uintptr_t host_addr, reg_t paddr, reg_t len, const uint8_t* bytes, xlate_flags_t xlate_flags);
+  bool bulk_span_in_tlb(const dtlb_entry_t* tlb, reg_t addr, reg_t len);
   bool mmio_fetch(reg_t paddr, size_t len, uint8_t* bytes);
   bool mmio_load(reg_t paddr, size_t len, uint8_t* bytes);
   bool mmio_store(reg_t paddr, size_t len, const uint8_t* bytes);
@@ -520,9 +583,12 @@ private:
 #else
   static const bool target_big_endian = false;
 #endif
-  bool check_triggers_fetch;
-  bool check_triggers_load;
-  bool check_triggers_store;
+  // Sorted, disjoint address intervals at which an armed trigger might
+  // fire, indexed by triggers::operation_t. Only TLB entries for pages that
+  // overlap them are marked TLB_CHECK_TRIGGERS, and only accesses that fall
+  // in them are passed to the trigger module.
+  std::vector<std::pair<reg_t, reg_t>> trigger_ranges[3];
+  bool trigger_may_match(triggers::operation_t operation, reg_t lo, reg_t hi) const;
   std::optional<triggers::matched_t> matched_trigger;
 
   friend class processor_t;
@@ -6,6 +6,7 @@
 #include "term.h"
 #include "sim.h"
 #include "dts.h"
+#include "checkpoint.h"
 
 #define UART_QUEUE_SIZE         64
 
@@ -328,6 +329,28 @@ void ns16550_t::tick(reg_t UNUSED rtc_ticks)
   update_interrupt();
 }
 
+void ns16550_t::save(checkpoint_buf_t& buf)
+{
+  for (uint8_t reg : {dll, dlm, iir, ier, fcr, lcr, mcr, lsr, msr, scr})
+    buf.put(reg);
+
+  auto rx = rx_queue;
+  buf.put<uint64_t>(rx.size());
+  for (; !rx.empty(); rx.pop())
+    buf.put(rx.front());
+}
+
+void ns16550_t::restore(checkpoint_buf_t& buf)
+{
+  for (uint8_t* reg : {&dll, &dlm, &iir, &ier, &fcr, &lcr, &mcr, &lsr, &msr, &scr})
+    buf.get(reg);
+
+  rx_queue = std::queue<uint8_t>();
+  for (auto n = buf.get<uint64_t>(); n > 0; n--)
+    rx_queue.push(buf.get<uint8_t>());
+  backoff_counter = 0;
+}
+
 std::string ns16550_generate_dts(const sim_t* sim, const std::vector<std::string>& sargs UNUSED)
 {
   std::stringstream s;
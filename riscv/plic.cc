@@ -5,6 +5,7 @@
 #include "simif.h"
 #include "sim.h"
 #include "dts.h"
+#include "checkpoint.h"
 
 #define PLIC_MAX_CONTEXTS 15872
 
@@ -403,6 +404,32 @@ bool plic_t::store(reg_t addr, size_t len, const uint8_t* bytes)
   return ret;
 }
 
+void plic_t::save(checkpoint_buf_t& buf)
+{
+  buf.put(priority);
+  buf.put(level);
+  for (const auto& c : contexts) {
+    buf.put(c.priority_threshold);
+    buf.put(c.enable);
+    buf.put(c.pending);
+    buf.put(c.pending_priority);
+    buf.put(c.claimed);
+  }
+}
+
+void plic_t::restore(checkpoint_buf_t& buf)
+{
+  buf.get(&priority);
+  buf.get(&level);
+  for (auto& c : contexts) {
+    buf.get(&c.priority_threshold);
+    buf.get(&c.enable);
+    buf.get(&c.pending);
+    buf.get(&c.pending_priority);
+    buf.get(&c.claimed);
+  }
+}
+
 std::string plic_generate_dts(const sim_t* sim, const std::vector<std::string>& sargs UNUSED)
 {
   std::stringstream s;
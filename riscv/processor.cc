@@ -22,6 +22,9 @@
 #include <stdexcept>
 #include <string>
 #include <algorithm>
+#include <array>
+#include <map>
+#include <utility>
 
 #ifdef __GNUC__
 # pragma GCC diagnostic ignored "-Wunused-variable"
@@ -36,10 +39,15 @@ processor_t::processor_t(const char* isa_str, const char* priv_str,
                          FILE* log_file, std::ostream& sout_)
 : debug(false), halt_request(HR_NONE), isa(isa_str, priv_str), cfg(cfg),
   sim(sim), id(id), xlen(isa.get_max_xlen()),
-  histogram_enabled(false), log_commits_enabled(false),
+  histogram_enabled(false), insn_profile_enabled(false), log_commits_enabled(false),
+  log_commits_writer(nullptr), log_commits_filtered(false),
+  log_commits_watching(false), retired_insns(0),
+  sample_profile(nullptr), sample_countdown(0),
+  bbv_profile(nullptr), bbv_countdown(0), bbv_block_pc(0), bbv_block_start(0),
   log_file(log_file), sout_(sout_.rdbuf()), halt_on_reset(halt_on_reset),
   in_wfi(false), check_triggers_icount(false),
   impl_table(256, false), extension_enable_table(isa.get_extension_table()),
+  histogram_page(-1), histogram_counts(nullptr),
   last_pc(1), executions(1), TM(cfg->trigger_count)
 {
   VU.p = this;
@@ -86,15 +94,10 @@ processor_t::processor_t(const char* isa_str, const char* priv_str,
 processor_t::~processor_t()
 {
   if (histogram_enabled)
-  {
-    std::vector<std::pair<reg_t, uint64_t>> ordered_histo(pc_histogram.begin(), pc_histogram.end());
-    std::sort(ordered_histo.begin(), ordered_histo.end(),
-              [](auto& lhs, auto& rhs) { return lhs.second < rhs.second; });
+    print_histogram();
 
-    fprintf(stderr, "PC Histogram size:%zu\n", ordered_histo.size());
-    for (auto it : ordered_histo)
-      fprintf(stderr, "%0" PRIx64 " %" PRIu64 "\n", it.first, it.second);
-  }
+  if (insn_profile_enabled)
+    print_insn_profile();
 
   delete mmu;
   delete disassembler;
@@ -140,11 +143,263 @@ void processor_t::set_debug(bool value)
 void processor_t::set_histogram(bool value)
 {
   histogram_enabled = value;
+  update_insn_profile();
+}
+
+void processor_t::update_histogram(reg_t pc)
+{
+  reg_t page = pc >> HISTOGRAM_PAGE_SHIFT;
+  if (unlikely(page != histogram_page)) {
+    auto& counts = pc_histogram[page];
+    if (!counts)
+      counts.reset(new uint64_t[(1 << HISTOGRAM_PAGE_SHIFT) / 2]());
+    histogram_page = page;
+    histogram_counts = counts.get();
+  }
+  histogram_counts[(pc & ((1 << HISTOGRAM_PAGE_SHIFT) - 1)) / 2]++;
+}
+
+void processor_t::set_sample_profile(sample_profile_t* profile)
+{
+  sample_profile = profile;
+  sample_countdown = profile ? profile->get_period() : 0;
+}
+
+void processor_t::set_bbv_profile(bbv_profile_t* profile)
+{
+  bbv_profile = profile;
+  bbv_countdown = profile ? profile->get_interval() : 0;
+  bbv_block_pc = state.pc;
+  bbv_block_start = retired_insns;
+}
+
+// Records the next pc and the return addresses above it. They come from the
+// shadow stack when Zicfiss keeps one, and otherwise from the frame-pointer
+// chain the standard calling convention lays out when frame pointers are
+// kept: the return address at fp - XLEN/8 and the caller's fp below it.
+// The walk reads memory only through mmu_t::peek, so it stops at the first
+// frame whose translation isn't in the TLB rather than disturb the hart.
+void processor_t::take_sample()
+{
+  const size_t max_depth = 128;
+  const reg_t width = xlen / 8;
+  std::vector<reg_t> stack{state.pc};
+
+  auto peek = [&](reg_t addr, reg_t* value) {
+    if (xlen == 32) {
+      uint32_t word;
+      if (!mmu->peek(addr, &word))
+        return false;
+      *value = word;
+      return true;
+    }
+    return mmu->peek(addr, value);
+  };
+
+  bool sse = extension_enabled(EXT_ZICFISS) && state.prv != PRV_M &&
+             get_field(state.menvcfg->read(), MENVCFG_SSE) && extension_enabled('S') &&
+             (!state.v || get_field(state.henvcfg->read(), HENVCFG_SSE)) &&
+             (state.prv != PRV_U || get_field(state.senvcfg->read(), SENVCFG_SSE));
+
+  if (sse) {
+    reg_t ra;
+    for (reg_t ssp = state.ssp->read(); stack.size() < max_depth && peek(ssp, &ra) && ra; ssp += width)
+      stack.push_back(ra);
+  } else {
+    reg_t fp = state.XPR[X_S0], ra, prev_fp;
+    while (stack.size() < max_depth && fp >= 2 * width &&
+           peek(fp - width, &ra) && peek(fp - 2 * width, &prev_fp) && ra) {
+      stack.push_back(ra);
+      // the stack grows down, so anything else is the end of the chain
+      if (prev_fp <= fp)
+        break;
+      fp = prev_fp;
+    }
+  }
+
+  sample_profile->add_sample(id, state.prv, state.v, stack);
+}
+
+void processor_t::print_histogram()
+{
+  std::vector<std::pair<reg_t, uint64_t>> ordered_histo;
+  for (auto& page : pc_histogram) {
+    for (reg_t i = 0; i < (1 << HISTOGRAM_PAGE_SHIFT) / 2; i++) {
+      if (page.second[i])
+        ordered_histo.push_back(std::make_pair((page.first << HISTOGRAM_PAGE_SHIFT) + 2 * i, page.second[i]));
+    }
+  }
+  std::sort(ordered_histo.begin(), ordered_histo.end(),
+            [](auto& lhs, auto& rhs) { return lhs.second < rhs.second; });
+
+  fprintf(stderr, "PC Histogram size:%zu\n", ordered_histo.size());
+  for (auto it : ordered_histo)
+    fprintf(stderr, "%0" PRIx64 " %" PRIu64 "\n", it.first, it.second);
+
+  // attribute each pc to the closest symbol at or below it
+  std::map<std::string, uint64_t> symbol_histo;
+  for (auto it : ordered_histo) {
+    if (const char* sym = sim->get_symbol_before(it.first))
+      symbol_histo[sym] += it.second;
+  }
+  if (symbol_histo.empty())
+    return;
+
+  std::vector<std::pair<std::string, uint64_t>> ordered_symbols(symbol_histo.begin(), symbol_histo.end());
+  std::stable_sort(ordered_symbols.begin(), ordered_symbols.end(),
+                   [](auto& lhs, auto& rhs) { return lhs.second < rhs.second; });
+
+  fprintf(stderr, "PC Histogram by symbol:\n");
+  for (auto& it : ordered_symbols)
+    fprintf(stderr, "%" PRIu64 " %s\n", it.second, it.first.c_str());
+}
+
+// Counting wrappers for --insn-profile: the one for profile slot I counts
+// the instruction and calls the function that decode_insn would have used.
+static const size_t insn_profile_slots = 2048;
+
+inline reg_t processor_t::profile_insn(size_t slot, insn_t insn, reg_t pc)
+{
+  insn_profile_entry_t& entry = insn_profile[slot];
+  reg_t prv = state.prv;
+  reg_t npc = entry.func(this, insn, pc);
+
+  // count instructions that retire, and serializing ones only once
+  if (npc != PC_SERIALIZE_BEFORE) {
+    entry.count[prv]++;
+    if (histogram_enabled)
+      update_histogram(pc);
+  }
+  return npc;
+}
+
+template<size_t I>
+static reg_t insn_profile_wrapper(processor_t* p, insn_t insn, reg_t pc)
+{
+  return p->profile_insn(I, insn, pc);
+}
+
+template<size_t... I>
+static constexpr std::array<insn_func_t, sizeof...(I)> make_insn_profile_wrappers(std::index_sequence<I...>)
+{
+  return {insn_profile_wrapper<I>...};
+}
+
+static constexpr auto insn_profile_wrappers =
+  make_insn_profile_wrappers(std::make_index_sequence<insn_profile_slots>());
+
+void processor_t::set_insn_profile(bool value)
+{
+  insn_profile_enabled = value;
+  update_insn_profile();
+}
+
+// -g and --insn-profile both count instructions through the wrappers
+void processor_t::update_insn_profile()
+{
+  insn_profile.resize(insn_profile_enabled || histogram_enabled ? insn_profile_slots : 0);
+  mmu->flush_tlb(); // the icache holds decoded instructions
+}
+
+insn_func_t processor_t::profile_insn_func(const insn_desc_t* desc, insn_func_t func)
+{
+  // the static illegal_instruction stands for the catch-all at the end
+  size_t slot = instructions.size() - 1;
+  if (desc >= &instructions.front() && desc <= &instructions.back())
+    slot = desc - &instructions.front();
+  else if (!custom_instructions.empty() &&
+           desc >= &custom_instructions.front() && desc <= &custom_instructions.back())
+    slot = instructions.size() + (desc - &custom_instructions.front());
+
+  if (slot >= insn_profile.size())
+    return func; // not counted
+  insn_profile[slot].func = func;
+  return insn_profile_wrappers[slot];
+}
+
+void processor_t::print_insn_profile()
+{
+  static const std::unordered_map<std::string, const char*> groups = {
+    #define DEFINE_INSN_GROUP(name, group) {#name, #group},
+    #include "insn_groups.h"
+    #undef DEFINE_INSN_GROUP
+  };
+
+  struct row_t {
+    std::string name;
+    std::string group;
+    uint64_t count[4];
+    uint64_t total;
+  };
+  std::vector<row_t> rows;
+  std::map<std::string, uint64_t> group_totals;
+  uint64_t priv_totals[4] = {0, 0, 0, 0};
+  uint64_t total = 0;
+
+  for (size_t slot = 0; slot < insn_profile.size(); slot++) {
+    const insn_profile_entry_t& entry = insn_profile[slot];
+    uint64_t sum = entry.count[PRV_U] + entry.count[PRV_S] + entry.count[PRV_HS] + entry.count[PRV_M];
+    if (sum == 0)
+      continue;
+
+    row_t row;
+    if (slot < instruction_names.size()) {
+      row.name = instruction_names[slot];
+      auto it = groups.find(row.name);
+      row.group = it == groups.end() ? "" : it->second;
+      std::replace(row.name.begin(), row.name.end(), '_', '.');
+      if (row.group.compare(0, 4, "ext_") == 0)
+        row.group.erase(0, 4);
+    } else {
+      const insn_desc_t& desc = custom_instructions[slot - instructions.size()];
+      const disasm_insn_t* disasm = disassembler->lookup(desc.match);
+      row.name = disasm ? disasm->get_name() : "unknown";
+      row.group = "custom";
+    }
+    memcpy(row.count, entry.count, sizeof(row.count));
+    row.total = sum;
+    rows.push_back(row);
+
+    group_totals[row.group] += sum;
+    for (size_t i = 0; i < 4; i++)
+      priv_totals[i] += entry.count[i];
+    total += sum;
+  }
+
+  std::sort(rows.begin(), rows.end(), [](auto& lhs, auto& rhs) {
+    return lhs.total != rhs.total ? lhs.total > rhs.total : lhs.name < rhs.name;
+  });
+
+  fprintf(stderr, "Instruction profile of core %" PRIu32 ": %" PRIu64 " instructions\n", id, total);
+  fprintf(stderr, "%14s %14s %14s %14s %-10s %s\n", "total", "U", "S", "M", "group", "instruction");
+  for (auto& row : rows) {
+    fprintf(stderr, "%14" PRIu64 " %14" PRIu64 " %14" PRIu64 " %14" PRIu64 " %-10s %s\n",
+            row.total, row.count[PRV_U], row.count[PRV_S], row.count[PRV_M],
+            row.group.c_str(), row.name.c_str());
+  }
+
+  std::vector<std::pair<std::string, uint64_t>> ordered_groups(group_totals.begin(), group_totals.end());
+  std::stable_sort(ordered_groups.begin(), ordered_groups.end(),
+                   [](auto& lhs, auto& rhs) { return lhs.second > rhs.second; });
+  fprintf(stderr, "By group:\n");
+  for (auto& it : ordered_groups)
+    fprintf(stderr, "%14" PRIu64 " %6.2f%% %s\n", it.second, 100.0 * it.second / total, it.first.c_str());
+
+  fprintf(stderr, "By privilege mode:\n");
+  for (reg_t prv : {PRV_U, PRV_S, PRV_M})
+    fprintf(stderr, "%14" PRIu64 " %6.2f%% %c\n", priv_totals[prv],
+            total ? 100.0 * priv_totals[prv] / total : 0.0, "USHM"[prv]);
 }
 
-void processor_t::enable_log_commits()
+void processor_t::enable_log_commits(commit_log_writer_t *writer,
+                                     const commit_log_filter_t& filter)
 {
-  log_commits_enabled = true;
+  // with filters, step() turns logging on where they select
+  log_commits_filtered = filter.any();
+  log_commits_watching = false;
+  log_commits_filter = filter;
+  log_commits_enabled = !log_commits_filtered;
+  log_commits_writer = writer;
   mmu->flush_tlb(); // the TLB caches this setting
 }
 
@@ -152,6 +407,9 @@ void processor_t::reset()
 {
   xlen = isa.get_max_xlen();
   state.reset(this, isa.get_max_isa());
+  mmu->flush_pmp();
+  mmu->flush_tlb();
+  mmu->set_tlb_privilege(state.prv, state.v);
   if (any_vector_extensions())
     VU.reset();
   in_wfi = false;
@@ -173,6 +431,195 @@ void processor_t::reset()
     sim->proc_reset(id);
 }
 
+// Checkpoints restore CSRs by writing back what they read, except for these:
+// the counters, which take writes only at the next bump; mip, some of whose
+// bits are driven by devices; vl and vtype, which only vsetvl can set; and
+// the trigger registers, which are saved for each trigger in turn.
+static bool is_checkpoint_special_csr(reg_t addr)
+{
+  switch (addr) {
+    case CSR_MINSTRET: case CSR_MINSTRETH: case CSR_INSTRET: case CSR_INSTRETH:
+    case CSR_MCYCLE: case CSR_MCYCLEH: case CSR_CYCLE: case CSR_CYCLEH:
+    case CSR_MIP: case CSR_MIPH:
+    case CSR_VL: case CSR_VTYPE:
+    case CSR_TSELECT: case CSR_TDATA1: case CSR_TDATA2: case CSR_TDATA3:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// The status registers follow the FP and vector CSRs, whose writes mark
+// their state dirty, and pmpcfg and mseccfg go last, since they can lock
+// the registers before them
+static int checkpoint_csr_order(reg_t addr)
+{
+  switch (addr) {
+    case CSR_MISA:
+      return 0;
+    case CSR_MSTATUS: case CSR_MSTATUSH: case CSR_SSTATUS: case CSR_VSSTATUS:
+      return 2;
+    case CSR_MSECCFG: case CSR_MSECCFGH:
+      return 4;
+    default:
+      return addr >= CSR_PMPCFG0 && addr <= CSR_PMPCFG15 ? 3 : 1;
+  }
+}
+
+static const reg_t checkpoint_trigger_csrs[] = {CSR_TDATA1, CSR_TDATA2, CSR_TDATA3};
+
+void processor_t::save(checkpoint_buf_t& buf)
+{
+  buf.put(id);
+  buf.put(state.pc);
+  for (size_t i = 0; i < NXPR; i++)
+    buf.put(state.XPR[i]);
+  for (size_t i = 0; i < NFPR; i++)
+    buf.put(state.FPR[i]);
+  buf.put(state.prv);
+  buf.put(state.v);
+  buf.put(state.debug_mode);
+  buf.put(state.single_step);
+  buf.put(state.elp);
+  buf.put(in_wfi);
+  buf.put(retired_insns);
+
+  // Virtualized CSRs read their HS-mode halves with V clear; the VS-mode
+  // registers have addresses of their own.
+  reg_t prv = state.prv;
+  bool v = state.v;
+  state.prv = PRV_M;
+  state.v = false;
+
+  std::vector<reg_t> addrs;
+  for (auto& [addr, csr] : state.csrmap) {
+    if (!is_checkpoint_special_csr(addr))
+      addrs.push_back(addr);
+  }
+  std::sort(addrs.begin(), addrs.end(), [](reg_t a, reg_t b) {
+    return std::make_pair(checkpoint_csr_order(a), a) < std::make_pair(checkpoint_csr_order(b), b);
+  });
+  buf.put<uint64_t>(addrs.size());
+  for (reg_t addr : addrs) {
+    buf.put(addr);
+    buf.put(state.csrmap[addr]->read());
+  }
+
+  buf.put(state.minstret->read());
+  buf.put(state.mcycle->read());
+  buf.put(state.mip->backdoor_read());
+
+  reg_t tselect = state.tselect->read();
+  buf.put(tselect);
+  for (unsigned i = 0; i < TM.count(); i++) {
+    state.tselect->write(i);
+    for (reg_t addr : checkpoint_trigger_csrs) {
+      auto search = state.csrmap.find(addr);
+      buf.put(search != state.csrmap.end() ? search->second->read() : 0);
+    }
+  }
+  state.tselect->write(tselect);
+
+  if (any_vector_extensions()) {
+    buf.put(VU.vl->read());
+    buf.put(VU.vtype->read());
+    buf.put(VU.vstart->read());
+    buf.put_bytes(VU.reg_file, NVPR * VU.vlenb);
+  }
+
+  state.prv = prv;
+  state.v = v;
+  state.log_reg_write.clear();
+}
+
+void processor_t::restore(checkpoint_buf_t& buf)
+{
+  if (buf.get<uint32_t>() != id)
+    throw std::runtime_error("checkpoint harts don't match the configuration");
+
+  buf.get(&state.pc);
+  for (size_t i = 0; i < NXPR; i++)
+    state.XPR.write(i, buf.get<reg_t>());
+  for (size_t i = 0; i < NFPR; i++)
+    state.FPR.write(i, buf.get<freg_t>());
+  reg_t prv = buf.get<reg_t>();
+  bool v = buf.get<bool>();
+  buf.get(&state.debug_mode);
+  buf.get(&state.single_step);
+  buf.get(&state.elp);
+  buf.get(&in_wfi);
+  buf.get(&retired_insns);
+
+  state.prv = PRV_M;
+  state.v = false;
+
+  // Write every CSR twice, so that fields that depend on later CSRs settle
+  std::vector<std::pair<reg_t, reg_t>> csrs(buf.get<uint64_t>());
+  for (auto& [addr, val] : csrs) {
+    buf.get(&addr);
+    buf.get(&val);
+  }
+  for (int pass = 0; pass < 2; pass++) {
+    // FP and vector CSRs can only be written while their state isn't off
+    state.mstatus->write(state.mstatus->read() | MSTATUS_FS | MSTATUS_VS);
+    for (auto& [addr, val] : csrs) {
+      auto search = state.csrmap.find(addr);
+      if (search == state.csrmap.end())
+        throw std::runtime_error("checkpoint CSRs don't match the configuration");
+      search->second->write(val);
+    }
+  }
+
+  state.minstret->write(buf.get<reg_t>());
+  state.minstret->bump(0);
+  state.mcycle->write(buf.get<reg_t>());
+  state.mcycle->bump(0);
+  state.mip->backdoor_write_with_mask(~reg_t(0), buf.get<reg_t>());
+
+  reg_t tselect = buf.get<reg_t>();
+  // outside debug mode, tdata1 writes would drop DMODE from debugger triggers
+  const bool debug_mode = state.debug_mode;
+  state.debug_mode = true;
+  for (unsigned i = 0; i < TM.count(); i++) {
+    state.tselect->write(i);
+    for (reg_t addr : checkpoint_trigger_csrs) {
+      reg_t val = buf.get<reg_t>();
+      if (auto search = state.csrmap.find(addr); search != state.csrmap.end())
+        search->second->write(val);
+    }
+  }
+  state.tselect->write(tselect);
+  state.debug_mode = debug_mode;
+
+  if (any_vector_extensions()) {
+    reg_t vl = buf.get<reg_t>();
+    reg_t vtype = buf.get<reg_t>();
+    reg_t vstart = buf.get<reg_t>();
+    VU.set_vl(1, 1, vl, vtype);
+    VU.vstart->write_raw(vstart);
+    buf.get_bytes(VU.reg_file, NVPR * VU.vlenb);
+  }
+
+  set_privilege(prv, v);
+  state.prev_prv = state.prv;
+  state.prev_v = state.v;
+  state.prv_changed = false;
+  state.v_changed = false;
+  state.serialized = false;
+
+  state.log_reg_write.clear();
+  state.log_mem_read.clear();
+  state.log_mem_write.clear();
+
+  mmu->yield_load_reservation();
+  mmu->flush_pmp();
+  mmu->flush_tlb();
+
+  // basic-block vectors start over from the restored hart
+  bbv_block_pc = state.pc;
+  bbv_block_start = retired_insns;
+}
+
 extension_t* processor_t::get_extension()
 {
   switch (custom_extensions.size()) {
@@ -201,6 +648,7 @@ void processor_t::set_pmp_num(reg_t n)
     abort();
   }
   n_pmp = n;
+  mmu->flush_pmp();
 }
 
 void processor_t::set_pmp_granularity(reg_t gran)
@@ -213,6 +661,7 @@ void processor_t::set_pmp_granularity(reg_t gran)
   }
 
   lg_pmp_granularity = ctz(gran);
+  mmu->flush_pmp();
 }
 
 void processor_t::set_mmu_capability(int cap)
@@ -356,11 +805,11 @@ reg_t processor_t::legalize_privilege(reg_t prv)
 
 void processor_t::set_privilege(reg_t prv, bool virt)
 {
-  mmu->flush_tlb();
   state.prev_prv = state.prv;
   state.prev_v = state.v;
   state.prv = legalize_privilege(prv);
   state.v = virt && state.prv != PRV_M;
+  mmu->set_tlb_privilege(state.prv, state.v);
   state.prv_changed = state.prv != state.prev_prv;
   state.v_changed = state.v != state.prev_v;
 }
@@ -392,6 +841,7 @@ void processor_t::enter_debug_mode(uint8_t cause, uint8_t extcause)
   state.dcsr->update_fields(cause, extcause, state.prv, state.v, state.elp);
   state.elp = elp_t::NO_LP_EXPECTED;
   set_privilege(PRV_M, false);
+  mmu->flush_tlb(); // in_mprv() depends on debug_mode
   state.dpc->write(state.pc);
   state.pc = DEBUG_ROM_ENTRY;
   in_wfi = false;
@@ -689,7 +1139,10 @@ insn_func_t processor_t::decode_insn(insn_t insn)
     opcode_cache[idx].replace(insn.bits(), desc);
   }
 
-  return desc->func(xlen, rve, log_commits_enabled);
+  insn_func_t func = desc->func(xlen, rve, log_commits_enabled);
+  if (unlikely(!insn_profile.empty()))
+    func = profile_insn_func(desc, func);
+  return func;
 }
 
 void processor_t::register_insn(insn_desc_t desc, bool is_custom) {
@@ -758,6 +1211,7 @@ void processor_t::register_base_instructions()
       logged_rv64e_##name \
     }; \
     register_base_insn(insn); \
+    instruction_names.push_back(#name); \
   }
 
   // add overlapping instructions first, in order
@@ -780,6 +1234,7 @@ void processor_t::register_base_instructions()
 
   // terminate instruction list with a catch-all
   register_base_insn(insn_desc_t::illegal_instruction);
+  instruction_names.push_back("illegal");
 
   build_opcode_map();
 }
@@ -822,24 +1277,28 @@ reg_t processor_t::size()
 
 void processor_t::trigger_updated(const std::vector<triggers::trigger_t *> &triggers)
 {
-  mmu->flush_tlb();
-  mmu->check_triggers_fetch = false;
-  mmu->check_triggers_load = false;
-  mmu->check_triggers_store = false;
+  std::vector<std::pair<reg_t, reg_t>> fetch_ranges, load_ranges, store_ranges;
   check_triggers_icount = false;
 
   for (auto trigger : triggers) {
+    reg_t lo, hi;
+    trigger->address_range(&lo, &hi);
     if (trigger->get_execute()) {
-      mmu->check_triggers_fetch = true;
+      fetch_ranges.push_back({lo, hi});
     }
     if (trigger->get_load()) {
-      mmu->check_triggers_load = true;
+      load_ranges.push_back({lo, hi});
     }
     if (trigger->get_store()) {
-      mmu->check_triggers_store = true;
+      store_ranges.push_back({lo, hi});
     }
     if (trigger->icount_check_needed()) {
       check_triggers_icount = true;
     }
   }
+
+  mmu->set_trigger_ranges(triggers::OPERATION_EXECUTE, fetch_ranges);
+  mmu->set_trigger_ranges(triggers::OPERATION_LOAD, load_ranges);
+  mmu->set_trigger_ranges(triggers::OPERATION_STORE, store_ranges);
+  mmu->flush_tlb();
 }
@@ -17,6 +17,10 @@
 #include "triggers.h"
 #include "../fesvr/memif.h"
 #include "vector_unit.h"
+#include "commit_log.h"
+#include "sample_profile.h"
+#include "bbv_profile.h"
+#include "checkpoint.h"
 
 #define FIRST_HPMCOUNTER 3
 #define N_HPMCOUNTERS 29
@@ -61,11 +65,62 @@ struct insn_desc_t
   static const insn_desc_t illegal_instruction;
 };
 
-// regnum, data
-typedef std::map<reg_t, freg_t> commit_log_reg_t;
+// Execution counts of one instruction for --insn-profile
+struct insn_profile_entry_t
+{
+  insn_func_t func; // the function that counting wrapper calls
+  uint64_t count[4]; // by privilege mode
+};
+
+// Per-instruction commit log entries, kept in insertion order. The first N
+// live inline; an instruction that needs more (e.g. a vector memory access)
+// spills them to the heap, and the spilled storage is kept across clear()
+// so that steady-state logging doesn't allocate.
+template<typename T, size_t N>
+class commit_log_list_t
+{
+public:
+  T* begin() { return spill.empty() ? inline_entries : spill.data(); }
+  T* end() { return begin() + len; }
+  const T* begin() const { return spill.empty() ? inline_entries : spill.data(); }
+  const T* end() const { return begin() + len; }
+  size_t size() const { return len; }
+  bool empty() const { return len == 0; }
+  void clear() { len = 0; }
+
+  void push_back(const T& x)
+  {
+    if (unlikely(len == (spill.empty() ? N : spill.size()))) {
+      if (spill.empty())
+        spill.assign(inline_entries, inline_entries + N);
+      spill.resize(2 * len);
+    }
+    begin()[len++] = x;
+  }
+
+private:
+  T inline_entries[N];
+  std::vector<T> spill;
+  size_t len = 0;
+};
+
+// regnum, data; a later write to the same register replaces the earlier one
+class commit_log_reg_t : public commit_log_list_t<std::pair<reg_t, freg_t>, 8>
+{
+public:
+  freg_t& operator[](reg_t key)
+  {
+    // the most recent entry is the likeliest match, e.g. for vector elements
+    for (auto it = end(); it != begin(); )
+      if ((--it)->first == key)
+        return it->second;
+    push_back(std::make_pair(key, freg_t()));
+    return (end() - 1)->second;
+  }
+};
 
 // addr, value, size
-typedef std::vector<std::tuple<reg_t, uint64_t, uint8_t>> commit_log_mem_t;
+typedef commit_log_list_t<std::tuple<reg_t, uint64_t, uint8_t>, 4> commit_log_mem_t;
 
 // architectural state of a RISC-V hart
 struct state_t
@@ -197,6 +252,7 @@ struct state_t
   reg_t last_inst_priv;
   int last_inst_xlen;
   int last_inst_flen;
+  std::vector<char> log_record; // scratch space for the text commit log
 
   elp_t elp;
 
@@ -262,10 +318,22 @@ public:
 
   void set_debug(bool value);
   void set_histogram(bool value);
-  void enable_log_commits();
+  void set_insn_profile(bool value);
+  // sample the pc and call stack into profile every profile->get_period()
+  // instructions, or stop sampling if profile is null
+  void set_sample_profile(sample_profile_t* profile);
+  // collect a basic-block vector into profile every profile->get_interval()
+  // instructions, or stop collecting if profile is null
+  void set_bbv_profile(bbv_profile_t* profile);
+  void enable_log_commits(commit_log_writer_t *writer = nullptr,
+                          const commit_log_filter_t& filter = commit_log_filter_t());
   bool get_log_commits_enabled() const { return log_commits_enabled; }
+  commit_log_writer_t *get_log_commits_writer() const { return log_commits_writer; }
   void reset();
   void step(size_t n); // run for n cycles
+  // serialize the architectural state of the hart, for checkpoints
+  void save(checkpoint_buf_t& buf);
+  void restore(checkpoint_buf_t& buf);
   void put_csr(int which, reg_t val);
   uint32_t get_id() const { return id; }
   reg_t get_csr(int which, insn_t insn, bool write, bool peek = 0);
@@ -337,6 +405,8 @@ public:
   void set_privilege(reg_t, bool);
   const char* get_privilege_string() const;
   void update_histogram(reg_t pc);
+  // called by the counting wrapper for the instruction in profile slot
+  reg_t profile_insn(size_t slot, insn_t insn, reg_t pc);
   const disassembler_t* get_disassembler() { return disassembler; }
 
   FILE *get_log_file() { return log_file; }
@@ -392,7 +462,19 @@ private:
   uint32_t id;
   unsigned xlen;
   bool histogram_enabled;
-  bool log_commits_enabled;
+  bool insn_profile_enabled;
+  bool log_commits_enabled; // for the current instruction, after filtering
+  commit_log_writer_t *log_commits_writer; // binary commit log, if selected
+  bool log_commits_filtered;
+  bool log_commits_watching; // for the start of the filter's pc range
+  commit_log_filter_t log_commits_filter;
+  reg_t retired_insns; // since the hart was created, for the filter window
+  sample_profile_t* sample_profile;
+  reg_t sample_countdown; // instructions until the next sample
+  bbv_profile_t* bbv_profile;
+  reg_t bbv_countdown; // instructions until the end of the interval
+  reg_t bbv_block_pc; // the basic block being executed
+  reg_t bbv_block_start; // the value of retired_insns when it was entered
   FILE *log_file;
   std::ostream sout_; // needed for socket command interface -s, also used for -d and -l, but not for --log
   bool halt_on_reset;
@@ -407,7 +489,14 @@ private:
 
   std::vector<insn_desc_t> instructions;
   std::vector<insn_desc_t> custom_instructions;
-  std::unordered_map<reg_t,uint64_t> pc_histogram;
+  // execution counts of each 2-byte-aligned pc, an array per 4 KiB page
+  static const int HISTOGRAM_PAGE_SHIFT = 12;
+  std::unordered_map<reg_t, std::unique_ptr<uint64_t[]>> pc_histogram;
+  reg_t histogram_page; // the page histogram_counts belongs to
+  uint64_t* histogram_counts;
+  // indexed by position in instructions, then in custom_instructions
+  std::vector<insn_profile_entry_t> insn_profile;
+  std::vector<const char*> instruction_names;
 
   static const size_t OPCODE_CACHE_SIZE = 4095;
   opcode_cache_entry_t opcode_cache[OPCODE_CACHE_SIZE];
@@ -418,7 +507,23 @@ private:
   void take_trap(trap_t& t, reg_t epc); // take an exception
   void take_trigger_action(triggers::action_t action, reg_t breakpoint_tval, reg_t epc, bool virt);
   void disasm(insn_t insn); // disassemble and print an instruction
+  void filter_log_commits(reg_t pc, size_t& limit, reg_t& watch_lo, reg_t& watch_span);
   void register_insn(insn_desc_t, bool);
+  insn_func_t profile_insn_func(const insn_desc_t* desc, insn_func_t func);
+  void update_insn_profile();
+  void print_insn_profile();
+  void print_histogram();
+  void take_sample();
+
+  // Credits the basic block being executed with the instructions retired up
+  // to now, and enters the one at pc
+  void enter_bbv_block(reg_t pc, reg_t now)
+  {
+    bbv_profile->add(bbv_block_pc, now - bbv_block_start);
+    bbv_block_pc = pc;
+    bbv_block_start = now;
+  }
+
   int paddr_bits();
 
   void enter_debug_mode(uint8_t cause, uint8_t ext_cause);
@@ -14,6 +14,13 @@ bool rom_device_t::load(reg_t addr, size_t len, uint8_t* bytes)
   return true;
 }
 
+char* rom_device_t::host_span(reg_t addr, bool write)
+{
+  if (write || addr >= data.size())
+    return nullptr;
+  return &data[addr];
+}
+
 bool rom_device_t::store(reg_t UNUSED addr, size_t UNUSED len, const uint8_t UNUSED *bytes)
 {
   return false;
@@ -0,0 +1,41 @@
+// See LICENSE for license details.
+
+#include "sample_profile.h"
+#include "simif.h"
+#include <cinttypes>
+#include <string>
+
+static std::string frame_name(simif_t* sim, reg_t addr)
+{
+  // addresses outside every symbol's range, like code loaded without
+  // symbols, are reported raw rather than after the nearest symbol below
+  if (const char* sym = sim->get_symbol_before(addr))
+    return sym;
+
+  char buf[2 + 16 + 1];
+  snprintf(buf, sizeof(buf), "0x%" PRIx64, addr);
+  return buf;
+}
+
+void sample_profile_t::write_folded(FILE* out, simif_t* sim) const
+{
+  static const char* const priv_names[] = {"U", "S", "H", "M"};
+
+  // stacks that differ only within functions fold into the same line
+  std::map<std::string, uint64_t> lines;
+  for (auto& [key, count] : samples) {
+    auto& [hartid, prv, virt, stack] = key;
+    std::string line = "core" + std::to_string(hartid) + ";" +
+                       (virt ? "V" : "") + priv_names[prv & 3];
+
+    // a return address follows the call, which may be the last instruction
+    // of its function, so name it after the byte before
+    for (size_t i = stack.size(); i-- > 0; )
+      line += ";" + frame_name(sim, i == 0 ? stack[i] : stack[i] - 1);
+
+    lines[line] += count;
+  }
+
+  for (auto& [line, count] : lines)
+    fprintf(out, "%s %" PRIu64 "\n", line.c_str(), count);
+}
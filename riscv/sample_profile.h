@@ -0,0 +1,40 @@
+// See LICENSE for license details.
+#ifndef _RISCV_SAMPLE_PROFILE_H
+#define _RISCV_SAMPLE_PROFILE_H
+
+#include <stdio.h>
+#include <map>
+#include <tuple>
+#include <vector>
+#include "decode.h"
+
+class simif_t;
+
+// Statistical profile of the guest, selected with --sample-profile: every
+// period instructions, each hart records its pc, privilege mode and call
+// stack here, and identical stacks are counted together.
+class sample_profile_t
+{
+public:
+  sample_profile_t(reg_t period) : period(period) {}
+
+  reg_t get_period() const { return period; }
+
+  // stack holds the pc first, then the return addresses, innermost first
+  void add_sample(uint32_t hartid, reg_t prv, bool virt, const std::vector<reg_t>& stack)
+  {
+    samples[std::make_tuple(hartid, prv, virt, stack)]++;
+  }
+
+  // Writes one line per distinct stack in the folded format read by
+  // flamegraph.pl and speedscope: the frames from the outermost in, separated
+  // by semicolons, then the number of samples. Frames are named after the
+  // ELF symbol containing them, if sim knows one.
+  void write_folded(FILE* out, simif_t* sim) const;
+
+private:
+  reg_t period;
+  std::map<std::tuple<uint32_t, reg_t, bool, std::vector<reg_t>>, uint64_t> samples;
+};
+
+#endif
@@ -9,6 +9,7 @@
 #include "platform.h"
 #include "libfdt.h"
 #include "socketif.h"
+#include <algorithm>
 #include <fstream>
 #include <map>
 #include <iostream>
@@ -18,6 +19,7 @@
 #include <cassert>
 #include <signal.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <sys/wait.h>
 #include <sys/types.h>
 
@@ -51,9 +53,18 @@ sim_t::sim_t(const cfg_t *cfg, bool halted,
     mems(mems),
     dtb_enabled(dtb_enabled),
     log_file(log_path),
+    ic(nullptr),
+    dc(nullptr),
+    l2(nullptr),
+    cache_models_enabled(true),
+    cache_warmup(0),
+    cache_measure(0),
+    cache_window(0),
+    cache_measuring(false),
     cmd_file(cmd_file),
     instruction_limit(instruction_limit),
     sout_(nullptr),
+    steps_taken(0),
     current_step(0),
     current_proc(0),
     debug(false),
@@ -263,6 +274,9 @@ sim_t::sim_t(const cfg_t *cfg, bool halted,
 
 sim_t::~sim_t()
 {
+  if (sample_profile)
+    sample_profile->write_folded(sample_profile_file->get(), this);
+
   for (size_t i = 0; i < procs.size(); i++)
     delete procs[i];
   delete debug_mmu;
@@ -286,6 +300,7 @@ void sim_t::step(size_t n)
   {
     steps = std::min(n - i, INTERLEAVE - current_step);
     procs[current_proc]->step(steps);
+    steps_taken += steps;
 
     current_step += steps;
     if (current_step == INTERLEAVE)
@@ -319,15 +334,384 @@ void sim_t::set_histogram(bool value)
   }
 }
 
-void sim_t::configure_log(bool enable_log, bool enable_commitlog)
+void sim_t::set_insn_profile(bool value)
+{
+  for (processor_t *proc : procs)
+    proc->set_insn_profile(value);
+}
+
+void sim_t::set_sample_profile(reg_t period, const char* path)
+{
+  sample_profile_file.reset(new log_file_t(path));
+  sample_profile.reset(new sample_profile_t(period));
+  for (processor_t *proc : procs)
+    proc->set_sample_profile(sample_profile.get());
+}
+
+void sim_t::set_bbv_profile(reg_t interval, const char* path)
+{
+  for (processor_t *proc : procs) {
+    std::string name = path ? path : "";
+    if (path && procs.size() > 1)
+      name += "." + std::to_string(proc->get_id());
+    bbv_profiles.emplace_back(new bbv_profile_t(interval, path ? name.c_str() : nullptr));
+    proc->set_bbv_profile(bbv_profiles.back().get());
+  }
+}
+
+void sim_t::set_cache_models(icache_sim_t* ic, dcache_sim_t* dc, cache_sim_t* l2)
+{
+  this->ic = ic;
+  this->dc = dc;
+  this->l2 = l2;
+  enable_cache_models(cache_models_enabled);
+}
+
+void sim_t::enable_cache_models(bool enable)
+{
+  cache_models_enabled = enable;
+  for (processor_t *proc : procs) {
+    proc->get_mmu()->unregister_memtracers();
+    if (enable && ic) proc->get_mmu()->register_memtracer(ic);
+    if (enable && dc) proc->get_mmu()->register_memtracer(dc);
+  }
+}
+
+void sim_t::set_cache_windows(const std::vector<reg_t>& starts, reg_t warmup, reg_t measure)
+{
+  cache_window_starts = starts;
+  std::sort(cache_window_starts.begin(), cache_window_starts.end());
+  cache_warmup = warmup;
+  cache_measure = measure;
+  cache_window = 0;
+  cache_measuring = false;
+  enable_cache_models(false);
+}
+
+// The step at which the current window enters its next phase
+reg_t sim_t::next_cache_window_step() const
+{
+  reg_t start = cache_window_starts[cache_window];
+  if (!cache_models_enabled)
+    return start - std::min(start, cache_warmup);
+  if (!cache_measuring)
+    return start;
+  return start + cache_measure;
+}
+
+void sim_t::update_cache_windows()
+{
+  while (cache_window < cache_window_starts.size() && steps_taken >= next_cache_window_step()) {
+    reg_t start = cache_window_starts[cache_window];
+    if (!cache_models_enabled) {
+      enable_cache_models(true);
+    } else if (!cache_measuring) {
+      if (ic) ic->reset_stats();
+      if (dc) dc->reset_stats();
+      if (l2) l2->reset_stats();
+      cache_measuring = true;
+    } else {
+      std::cout << "Cache window at " << start << " for " << cache_measure
+                << " instructions:" << std::endl;
+      // skip caches the window never touched, rather than print a NaN miss rate
+      if (ic && ic->has_accesses()) ic->print_stats();
+      if (dc && dc->has_accesses()) dc->print_stats();
+      if (l2 && l2->has_accesses()) l2->print_stats();
+      if (ic) ic->reset_stats();
+      if (dc) dc->reset_stats();
+      if (l2) l2->reset_stats();
+      enable_cache_models(false);
+      cache_measuring = false;
+      cache_window++;
+    }
+  }
+}
+
+void sim_t::set_checkpoint_save(const char* path, reg_t steps)
+{
+  checkpoint_save_path = path;
+  checkpoint_save_steps = steps;
+}
+
+void sim_t::set_checkpoint_restore(const char* path)
+{
+  checkpoint_restore_path = path;
+}
+
+static uint64_t checkpoint_align(uint64_t offset)
+{
+  return (offset + CHECKPOINT_ALIGN - 1) & ~(CHECKPOINT_ALIGN - 1);
+}
+
+void sim_t::save_checkpoint(const char* path)
+{
+  checkpoint_buf_t buf;
+  buf.put<uint64_t>(procs.size());
+  for (auto& [base, mem] : mems) {
+    buf.put(base);
+    buf.put(mem->size());
+  }
+  buf.put(steps_taken);
+  buf.put(current_step);
+  buf.put(current_proc);
+
+  for (processor_t* proc : procs)
+    proc->save(buf);
+
+  // each device's state is prefixed with its size, so a mismatched
+  // configuration is caught on restore
+  for (auto& dev : devices) {
+    checkpoint_buf_t dev_buf;
+    dev->save(dev_buf);
+    buf.put<uint64_t>(dev_buf.data.size());
+    buf.put_bytes(dev_buf.data.data(), dev_buf.data.size());
+  }
+
+  checkpoint_file_header_t header = {};
+  memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+  header.version = CHECKPOINT_VERSION;
+  header.nmems = mems.size();
+  header.state_size = buf.data.size();
+  header.mems_offset = checkpoint_align(sizeof(header) + buf.data.size());
+
+  int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+    throw std::runtime_error(strerror(errno));
+
+  try {
+    checkpoint_pwrite(fd, &header, sizeof(header), 0);
+    checkpoint_pwrite(fd, buf.data.data(), buf.data.size(), sizeof(header));
+
+    uint64_t offset = header.mems_offset;
+    for (auto& [base, mem] : mems) {
+      mem->save_image(fd, offset);
+      offset = checkpoint_align(offset + mem->size());
+    }
+
+    // the holes at the end of the last image must be part of the file too
+    if (ftruncate(fd, offset) != 0)
+      throw std::runtime_error(strerror(errno));
+  } catch (...) {
+    close(fd);
+    throw;
+  }
+
+  close(fd);
+}
+
+bool sim_t::has_shared_mem()
+{
+  for (auto& [base, mem] : mems) {
+    auto m = dynamic_cast<mem_t*>(mem);
+    if (m && m->is_shared())
+      return true;
+  }
+  return false;
+}
+
+void sim_t::restore_checkpoint(const char* path)
+{
+  // the private mapping of the image would cut the region off from the
+  // processes sharing it
+  if (has_shared_mem())
+    throw std::runtime_error("can't restore into guest memory mapped with shm= or :shared");
+
+  int fd = open(path, O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error(strerror(errno));
+
+  try {
+    checkpoint_file_header_t header;
+    checkpoint_pread(fd, &header, sizeof(header), 0);
+    if (memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != CHECKPOINT_VERSION)
+      throw std::runtime_error("not a checkpoint (version " + std::to_string(CHECKPOINT_VERSION) + ")");
+
+    checkpoint_buf_t buf;
+    buf.data.resize(header.state_size);
+    checkpoint_pread(fd, buf.data.data(), buf.data.size(), sizeof(header));
+
+    bool match = header.nmems == mems.size() && buf.get<uint64_t>() == procs.size();
+    for (auto& [base, mem] : mems) {
+      match &= buf.get<reg_t>() == base;
+      match &= buf.get<reg_t>() == mem->size();
+    }
+    if (!match)
+      throw std::runtime_error("checkpoint harts or memories don't match the configuration");
+
+    buf.get(&steps_taken);
+    buf.get(&current_step);
+    buf.get(&current_proc);
+
+    for (processor_t* proc : procs)
+      proc->restore(buf);
+
+    for (auto& dev : devices) {
+      checkpoint_buf_t dev_buf;
+      dev_buf.data.resize(buf.get<uint64_t>());
+      buf.get_bytes(dev_buf.data.data(), dev_buf.data.size());
+      dev->restore(dev_buf);
+      if (dev_buf.pos != dev_buf.data.size())
+        throw std::runtime_error("checkpoint devices don't match the configuration");
+    }
+
+    uint64_t offset = header.mems_offset;
+    for (auto& [base, mem] : mems) {
+      mem->restore_image(fd, offset);
+      offset = checkpoint_align(offset + mem->size());
+    }
+  } catch (...) {
+    close(fd);
+    throw;
+  }
+
+  // the mappings of the memory images outlive the descriptor
+  close(fd);
+  debug_mmu->flush_tlb();
+}
+
+void sim_t::set_fork(reg_t steps, const std::vector<std::string>& configs)
+{
+  fork_steps = steps;
+  fork_configs = configs;
+}
+
+void sim_t::configure_fork_child(const std::string& config)
+{
+  std::stringstream ss(config);
+  std::string item;
+  bool caches_changed = false;
+
+  while (std::getline(ss, item, ',')) {
+    size_t eq = item.find('=');
+    if (eq == std::string::npos)
+      throw std::runtime_error("expected <key>=<value>, not '" + item + "'");
+    std::string key = item.substr(0, eq), value = item.substr(eq + 1);
+
+    if (key == "ic") {
+      fork_ic.reset(new icache_sim_t(value.c_str()));
+      caches_changed = true;
+    } else if (key == "dc") {
+      fork_dc.reset(new dcache_sim_t(value.c_str()));
+      caches_changed = true;
+    } else if (key == "l2") {
+      fork_l2.reset(cache_sim_t::construct(value.c_str(), "L2$"));
+      caches_changed = true;
+    } else if (key == "out") {
+      int fd = open(value.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+      if (fd < 0)
+        throw std::runtime_error("unable to open " + value + ": " + strerror(errno));
+      dup2(fd, STDOUT_FILENO);
+      dup2(fd, STDERR_FILENO);
+      close(fd);
+    } else if (key == "load") {
+      size_t at = value.rfind('@');
+      if (at == std::string::npos)
+        throw std::runtime_error("expected load=<file>@<hex addr>");
+      std::string path = value.substr(0, at);
+      reg_t addr = strtoull(value.c_str() + at + 1, NULL, 16);
+
+      std::ifstream in(path, std::ios::binary);
+      std::vector<char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+      if (!in.good() && !in.eof())
+        throw std::runtime_error("unable to read " + path);
+      memif().write(addr, data.size(), data.data());
+      for (processor_t* proc : procs)
+        proc->get_mmu()->flush_icache();
+    } else {
+      throw std::runtime_error("unknown key '" + key + "'");
+    }
+  }
+
+  // the cache models the config names replace the parent's; the others
+  // carry on warm, and feed the new L2$ if there is one
+  if (caches_changed) {
+    icache_sim_t* new_ic = fork_ic ? fork_ic.get() : ic;
+    dcache_sim_t* new_dc = fork_dc ? fork_dc.get() : dc;
+    cache_sim_t* new_l2 = fork_l2 ? fork_l2.get() : l2;
+    if (!new_ic && !new_dc)
+      throw std::runtime_error("l2= needs an I$ or D$ to feed it, from ic=, dc=, --ic or --dc");
+    if (new_ic && new_l2) new_ic->set_miss_handler(new_l2);
+    if (new_dc && new_l2) new_dc->set_miss_handler(new_l2);
+    set_cache_models(new_ic, new_dc, new_l2);
+  }
+}
+
+bool sim_t::fork_children(const std::vector<std::string>& configs, int* exit_status)
+{
+  // the binary commit log is written by a thread, which fork() doesn't copy
+  if (commit_log_writer)
+    throw std::runtime_error("can't fork with --log-commits-format=binary");
+  // the children would write the parent's samples again, into its streams
+  if (sample_profile || !bbv_profiles.empty())
+    throw std::runtime_error("can't fork with --sample-profile or --bbv");
+  // the children would all run on the same guest memory
+  if (has_shared_mem())
+    throw std::runtime_error("can't fork with guest memory mapped with shm= or :shared");
+
+  fflush(NULL);
+
+  std::vector<pid_t> children;
+  for (size_t i = 0; i < configs.size(); i++) {
+    pid_t pid = fork();
+    if (pid < 0) {
+      perror("fork");
+      break;
+    }
+
+    if (pid == 0) {
+      // the child runs to completion on its own, leaving the terminal and
+      // the debug command file to the parent
+      signal(SIGINT, SIG_DFL);
+      debug = false;
+      cmd_file = NULL;
+      set_procs_debug(log);
+      // report only what the child runs, so the inherited models don't
+      // repeat the parent's statistics, and replaced ones print nothing
+      if (ic) ic->reset_stats();
+      if (dc) dc->reset_stats();
+      if (l2) l2->reset_stats();
+      try {
+        configure_fork_child(configs[i]);
+      } catch (std::exception& e) {
+        std::cerr << "fork " << configs[i] << ": " << e.what() << std::endl;
+        exit(1);
+      }
+      return true;
+    }
+
+    children.push_back(pid);
+  }
+
+  *exit_status = children.size() == configs.size() ? 0 : 1;
+  for (size_t i = 0; i < children.size(); i++) {
+    int status;
+    while (waitpid(children[i], &status, 0) < 0 && errno == EINTR)
+      ;
+
+    int code = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+    std::cerr << "fork " << configs[i] << ": pid " << children[i]
+              << " exited with status " << code << std::endl;
+    if (*exit_status == 0)
+      *exit_status = code;
+  }
+
+  return false;
+}
+
+void sim_t::configure_log(bool enable_log, bool enable_commitlog, bool binary_commitlog,
+                          const commit_log_filter_t& commitlog_filter)
 {
   log = enable_log;
 
   if (!enable_commitlog)
     return;
 
+  if (binary_commitlog && !procs.empty())
+    commit_log_writer.reset(new commit_log_writer_t(log_file.get(), procs[0]->VU.VLEN));
+
   for (processor_t *proc : procs) {
-    proc->enable_log_commits();
+    proc->enable_log_commits(commit_log_writer.get(), commitlog_filter);
   }
 }
 
@@ -411,17 +795,53 @@ char* sim_t::addr_to_mem(reg_t paddr) {
   return NULL;
 }
 
+char* sim_t::addr_to_host(reg_t paddr, access_type type) {
+  if (!paddr_ok(paddr))
+    return NULL;
+  auto desc = bus.find_device(paddr >> PGSHIFT << PGSHIFT, PGSIZE);
+  if (desc.second)
+    return desc.second->host_span(paddr - desc.first, type == STORE);
+  return NULL;
+}
+
 const char* sim_t::get_symbol(uint64_t paddr)
 {
   return htif_t::get_symbol(paddr);
 }
 
+const char* sim_t::get_symbol_before(uint64_t addr)
+{
+  return htif_t::get_symbol_before(addr);
+}
+
 // htif
 
 void sim_t::reset()
 {
   if (dtb_enabled)
     set_rom();
+
+  if (!checkpoint_restore_path.empty()) {
+    try {
+      restore_checkpoint(checkpoint_restore_path.c_str());
+    } catch (std::exception& e) {
+      std::cerr << "unable to restore checkpoint " << checkpoint_restore_path
+                << ": " << e.what() << std::endl;
+      exit(1);
+    }
+
+    // idle() stops only exactly at the save point, which is now behind us
+    if (checkpoint_save_steps.has_value() && *checkpoint_save_steps < steps_taken) {
+      std::cerr << "can't save a checkpoint at " << *checkpoint_save_steps
+                << " instructions after restoring one at " << steps_taken << std::endl;
+      exit(1);
+    }
+    if (fork_steps.has_value() && *fork_steps < steps_taken) {
+      std::cerr << "can't fork at " << *fork_steps
+                << " instructions after restoring a checkpoint at " << steps_taken << std::endl;
+      exit(1);
+    }
+  }
 }
 
 void sim_t::idle()
@@ -432,17 +852,51 @@ void sim_t::idle()
   if (debug || ctrlc_pressed)
     interactive();
   else {
+    update_cache_windows();
+
+    // stop exactly where a checkpoint or a cache window phase is due
+    size_t n = INTERLEAVE;
+    if (cache_window < cache_window_starts.size())
+      n = std::min<reg_t>(n, next_cache_window_step() - steps_taken);
+    if (checkpoint_save_steps.has_value())
+      n = std::min<reg_t>(n, *checkpoint_save_steps - steps_taken);
+    if (fork_steps.has_value())
+      n = std::min<reg_t>(n, *fork_steps - steps_taken);
+
     if (instruction_limit.has_value()) {
-      if (*instruction_limit < INTERLEAVE) {
+      if (*instruction_limit < n) {
         // Final step.
         step(*instruction_limit);
         htif_exit(0);
         *instruction_limit = 0;
         return;
       }
-      *instruction_limit -= INTERLEAVE;
+      *instruction_limit -= n;
+    }
+    step(n);
+
+    if (checkpoint_save_steps.has_value() && steps_taken == *checkpoint_save_steps) {
+      checkpoint_save_steps.reset();
+      try {
+        save_checkpoint(checkpoint_save_path.c_str());
+      } catch (std::exception& e) {
+        std::cerr << "unable to save checkpoint " << checkpoint_save_path
+                  << ": " << e.what() << std::endl;
+        exit(1);
+      }
+    }
+
+    if (fork_steps.has_value() && steps_taken == *fork_steps) {
+      fork_steps.reset();
+      int status;
+      try {
+        if (!fork_children(fork_configs, &status))
+          htif_exit(status << 1 | 1); // encoded like an exit syscall's tohost
+      } catch (std::exception& e) {
+        std::cerr << "unable to fork: " << e.what() << std::endl;
+        exit(1);
+      }
     }
-    step(INTERLEAVE);
   }
 
   if (remote_bitbang)
@@ -7,6 +7,10 @@
 #include "debug_module.h"
 #include "devices.h"
 #include "log_file.h"
+#include "commit_log.h"
+#include "sample_profile.h"
+#include "checkpoint.h"
+#include "cachesim.h"
 #include "processor.h"
 #include "simif.h"
 
@@ -42,13 +46,52 @@ public:
   int run();
   void set_debug(bool value);
   void set_histogram(bool value);
+  // count executed instructions by mnemonic, group and privilege mode
+  void set_insn_profile(bool value);
+  // sample every hart's pc and call stack each period instructions, and write
+  // them as folded stacks to path, or stderr if it is null, at the end
+  void set_sample_profile(reg_t period, const char* path);
+  // collect each hart's basic-block vectors for SimPoint every interval
+  // instructions, into path (with the hart id appended if there are several
+  // harts), or stderr if it is null
+  void set_bbv_profile(reg_t interval, const char* path);
+  // Save a checkpoint to path once the simulation has taken the given number
+  // of steps (counted like --instructions), or restore one from path when the
+  // program has been loaded
+  void set_checkpoint_save(const char* path, reg_t steps);
+  void set_checkpoint_restore(const char* path);
+  void save_checkpoint(const char* path);
+  // Restoring maps the image privately over guest memory, so regions mapped
+  // with shm= or :shared are refused
+  void restore_checkpoint(const char* path);
+  // Fork one child per configuration once the simulation has taken the given
+  // number of steps; the parent waits for the children and exits with the
+  // first nonzero status. A configuration is a comma-separated list of
+  //   ic=<S>:<W>:<B>, dc=<S>:<W>:<B>, l2=<S>:<W>:<B>  replace those cache models
+  //   out=<file>                                      redirect stdout and stderr
+  //   load=<file>@<hex addr>                          copy file to physical memory
+  void set_fork(reg_t steps, const std::vector<std::string>& configs);
+  // Returns true in each child, and false in the parent once all children
+  // have exited, with the status to exit with in *exit_status. The cache
+  // statistics a child prints cover only the instructions it ran
+  bool fork_children(const std::vector<std::string>& configs, int* exit_status);
+  // Attach the cache models selected with --ic, --dc and --l2 to every hart
+  void set_cache_models(icache_sim_t* ic, dcache_sim_t* dc, cache_sim_t* l2);
+  // Run at full speed with the cache models detached, except for a window at
+  // each of the given step counts: they are attached warmup steps before it,
+  // and their statistics are counted and printed over the measure steps from
+  // it on
+  void set_cache_windows(const std::vector<reg_t>& starts, reg_t warmup, reg_t measure);
   void add_device(reg_t addr, std::shared_ptr<abstract_device_t> dev);
 
   // Configure logging
   //
   // If enable_log is true, an instruction trace will be generated. If
-  // enable_commitlog is true, so will the commit results
-  void configure_log(bool enable_log, bool enable_commitlog);
+  // enable_commitlog is true, so will the commit results, in the binary
+  // format of commit_log.h if binary_commitlog is also true, and only for
+  // the instructions that commitlog_filter selects
+  void configure_log(bool enable_log, bool enable_commitlog, bool binary_commitlog = false,
+                     const commit_log_filter_t& commitlog_filter = commit_log_filter_t());
 
   void set_procs_debug(bool value);
   void set_remote_bitbang(remote_bitbang_t* remote_bitbang) {
@@ -82,6 +125,27 @@ private:
   std::shared_ptr<plic_t> plic;
   bus_t bus;
   log_file_t log_file;
+  std::unique_ptr<commit_log_writer_t> commit_log_writer;
+  std::unique_ptr<sample_profile_t> sample_profile;
+  std::unique_ptr<log_file_t> sample_profile_file;
+  std::string checkpoint_save_path;
+  std::optional<reg_t> checkpoint_save_steps;
+  std::string checkpoint_restore_path;
+  std::optional<reg_t> fork_steps;
+  std::vector<std::string> fork_configs;
+  std::unique_ptr<icache_sim_t> fork_ic;
+  std::unique_ptr<dcache_sim_t> fork_dc;
+  std::unique_ptr<cache_sim_t> fork_l2;
+  std::vector<std::unique_ptr<bbv_profile_t>> bbv_profiles;
+  icache_sim_t* ic;
+  dcache_sim_t* dc;
+  cache_sim_t* l2;
+  bool cache_models_enabled;
+  std::vector<reg_t> cache_window_starts; // sorted
+  reg_t cache_warmup;
+  reg_t cache_measure;
+  size_t cache_window; // the next or current window
+  bool cache_measuring;
 
   FILE *cmd_file; // pointer to debug command input file
 
@@ -92,6 +156,7 @@ private:
 
   processor_t* get_core(const std::string& i);
   void step(size_t n); // step through simulation
+  reg_t steps_taken;
   size_t current_step;
   size_t current_proc;
   bool debug;
@@ -105,6 +170,7 @@ private:
   // For these purposes, only memories that include the entire base page
   // surrounding paddr are considered; smaller memories are treated as I/O.
   virtual char* addr_to_mem(reg_t paddr) override;
+  virtual char* addr_to_host(reg_t paddr, access_type type) override;
 
   // memory-mapped I/O routines
   virtual bool mmio_load(reg_t paddr, size_t len, uint8_t* bytes) override;
@@ -112,6 +178,7 @@ private:
   void set_rom();
 
   virtual const char* get_symbol(uint64_t paddr) override;
+  virtual const char* get_symbol_before(uint64_t addr) override;
 
   // presents a prompt for introspection into the simulation
   void interactive();
@@ -139,11 +206,18 @@ private:
   void interactive_until(const std::string& cmd, const std::vector<std::string>& args, bool noisy);
   void interactive_until_silent(const std::string& cmd, const std::vector<std::string>& args);
   void interactive_until_noisy(const std::string& cmd, const std::vector<std::string>& args);
+  void interactive_fork(const std::string& cmd, const std::vector<std::string>& args);
   reg_t get_reg(const std::vector<std::string>& args);
   freg_t get_freg(const std::vector<std::string>& args, int size);
   reg_t get_mem(const std::vector<std::string>& args);
   reg_t get_pc(const std::vector<std::string>& args);
   reg_t get_insn(const std::vector<std::string>& args);
+  void configure_fork_child(const std::string& config);
+  // whether any guest memory is mapped with shm= or :shared
+  bool has_shared_mem();
+  void enable_cache_models(bool enable);
+  reg_t next_cache_window_step() const;
+  void update_cache_windows();
 
   friend class processor_t;
   friend class mmu_t;
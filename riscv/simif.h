@@ -6,6 +6,8 @@
 #include <map>
 #include "decode.h"
 #include "cfg.h"
+#include "memtracer.h"
+#include "common.h"
 
 class processor_t;
 class mmu_t;
@@ -16,6 +18,9 @@ class simif_t
 public:
   // should return NULL for MMIO addresses
   virtual char* addr_to_mem(reg_t paddr) = 0;
+  // like addr_to_mem, but may also return memory-like device contents that
+  // are only usable for the given type of access (e.g. a read-only ROM)
+  virtual char* addr_to_host(reg_t paddr, access_type UNUSED type) { return addr_to_mem(paddr); }
   virtual bool reservable(reg_t paddr) { return addr_to_mem(paddr); }
   // used for MMIO addresses
   virtual bool mmio_fetch(reg_t paddr, size_t len, uint8_t* bytes) { return mmio_load(paddr, len, bytes); }
@@ -28,6 +33,8 @@ public:
   virtual const std::map<size_t, processor_t*>& get_harts() const = 0;
 
   virtual const char* get_symbol(uint64_t paddr) = 0;
+  // the named symbol at the highest address at or below addr, if any
+  virtual const char* get_symbol_before(uint64_t UNUSED addr) { return nullptr; }
 
   virtual ~simif_t() = default;
 
@@ -271,6 +271,38 @@ std::optional<match_result_t> mcontrol_common_t::detect_memory_access_match(proc
   return std::nullopt;
 }
 
+void mcontrol_common_t::address_range(reg_t *lo, reg_t *hi) const noexcept {
+  *lo = 0;
+  *hi = -1;
+
+  // Data value triggers can match at any address
+  if (select)
+    return;
+
+  switch (match) {
+    case MATCH_EQUAL:
+      *lo = *hi = tdata2;
+      break;
+    case MATCH_NAPOT:
+      // simple_match() builds this mask with an int shift
+      if (cto(tdata2) + 1 < 31) {
+        reg_t mask = ~((1 << (cto(tdata2)+1)) - 1);
+        *lo = tdata2 & mask;
+        *hi = tdata2 | ~mask;
+      }
+      break;
+    case MATCH_GE:
+      *lo = tdata2;
+      break;
+    case MATCH_LT:
+      *hi = tdata2 ? tdata2 - 1 : 0;
+      break;
+    case MATCH_MASK_LOW:
+    case MATCH_MASK_HIGH:
+      break;
+  }
+}
+
 mcontrol_common_t::match_t mcontrol_common_t::legalize_match(reg_t val, reg_t maskmax) noexcept
 {
   switch (val) {
@@ -379,6 +411,33 @@ void icount_t::detect_icount_decrement(processor_t * const proc) noexcept
   }
 }
 
+reg_t icount_t::icount_skip_limit(processor_t * const proc) noexcept
+{
+  skip_match = common_match(proc);
+  if (pending)
+    return 0;
+  if (!skip_match || count == 0)
+    return -1;
+  // Leave the decrement that sets pending to detect_icount_decrement()
+  return count - 1;
+}
+
+void icount_t::icount_skip(processor_t UNUSED * const proc, reg_t n) noexcept
+{
+  // Equivalent to n rounds of stash_read_values() and
+  // detect_icount_decrement(), none of which reach zero
+  if (n == 0)
+    return;
+
+  if (skip_match) {
+    count_read_value = count - (n - 1);
+    count -= n;
+  } else {
+    count_read_value = count;
+  }
+  pending_read_value = pending;
+}
+
 reg_t icount_t::tdata1_read(const processor_t * const proc) const noexcept
 {
   auto xlen = proc->get_xlen();
@@ -651,6 +710,20 @@ std::optional<match_result_t> module_t::detect_icount_match() noexcept
   return ret;
 }
 
+reg_t module_t::icount_skip_limit() noexcept
+{
+  reg_t limit = -1;
+  for (auto trigger: triggers)
+    limit = std::min(limit, trigger->icount_skip_limit(proc));
+  return limit;
+}
+
+void module_t::icount_skip(reg_t n) noexcept
+{
+  for (auto trigger: triggers)
+    trigger->icount_skip(proc, n);
+}
+
 std::optional<match_result_t> module_t::detect_trap_match(const trap_t& t) noexcept
 {
   state_t * const state = proc->get_state();
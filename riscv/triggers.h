@@ -92,8 +92,16 @@ public:
 
   virtual std::optional<match_result_t> detect_memory_access_match(processor_t UNUSED * const proc,
       operation_t UNUSED operation, reg_t UNUSED address, std::optional<reg_t> UNUSED data) noexcept { return std::nullopt; }
+  // Bounds [*lo, *hi] on the addresses at which detect_memory_access_match
+  // can match, ignoring privilege mode and xlen. May be an overestimate.
+  virtual void address_range(reg_t *lo, reg_t *hi) const noexcept { *lo = 0; *hi = -1; }
   virtual std::optional<match_result_t> detect_icount_fire(processor_t UNUSED * const proc) { return std::nullopt; }
   virtual void detect_icount_decrement(processor_t UNUSED * const proc) {}
+  // For running instructions without detect_icount_match(): how many may
+  // retire before this trigger needs it again, and the bulk update after
+  // n have. The privilege mode is sampled by icount_skip_limit().
+  virtual reg_t icount_skip_limit(processor_t UNUSED * const proc) noexcept { return -1; }
+  virtual void icount_skip(processor_t UNUSED * const proc, reg_t UNUSED n) noexcept {}
   virtual std::optional<match_result_t> detect_trap_match(processor_t UNUSED * const proc, const trap_t UNUSED & t) noexcept { return std::nullopt; }
 
 protected:
@@ -215,6 +223,7 @@ public:
 
   virtual std::optional<match_result_t> detect_memory_access_match(processor_t * const proc,
       operation_t operation, reg_t address, std::optional<reg_t> data) noexcept override;
+  virtual void address_range(reg_t *lo, reg_t *hi) const noexcept override;
 
 private:
   bool simple_match(unsigned xlen, reg_t value) const;
@@ -268,12 +277,15 @@ public:
 
   virtual std::optional<match_result_t> detect_icount_fire(processor_t * const proc) noexcept override;
   virtual void detect_icount_decrement(processor_t * const proc) noexcept override;
+  virtual reg_t icount_skip_limit(processor_t * const proc) noexcept override;
+  virtual void icount_skip(processor_t * const proc, reg_t n) noexcept override;
 
 private:
   bool dmode = false;
   bool hit = false;
   unsigned count = 1, count_read_value = 1;
   bool pending = false, pending_read_value = false;
+  bool skip_match = false;
   action_t action = (action_t)0;
 };
 
@@ -294,6 +306,8 @@ public:
 
   std::optional<match_result_t> detect_memory_access_match(operation_t operation, reg_t address, std::optional<reg_t> data) noexcept;
   std::optional<match_result_t> detect_icount_match() noexcept;
+  reg_t icount_skip_limit() noexcept;
+  void icount_skip(reg_t n) noexcept;
   std::optional<match_result_t> detect_trap_match(const trap_t& t) noexcept;
 
   processor_t *proc;
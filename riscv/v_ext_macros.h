@@ -259,10 +259,14 @@ static inline bool is_overlapped_widen(const int astart, int asize,
   require(P.VU.vsew <= e64); \
   require_vector(true); \
   reg_t vl = P.VU.vl->read(); \
-  for (reg_t i = P.VU.vstart->read(); i < vl; ++i) { \
-    bool vs2 = P.VU.mask_elt(insn.rs2(), i); \
-    bool vs1 = P.VU.mask_elt(insn.rs1(), i); \
-    P.VU.set_mask_elt(insn.rd(), i, (op)); \
+  if (VI_MASK_WORDS_ELIGIBLE) { \
+    VI_MASK_WORDS_LOGICAL(op, P.VU.vstart->read(), vl) \
+  } else { \
+    for (reg_t i = P.VU.vstart->read(); i < vl; ++i) { \
+      bool vs2 = P.VU.mask_elt(insn.rs2(), i); \
+      bool vs1 = P.VU.mask_elt(insn.rs1(), i); \
+      P.VU.set_mask_elt(insn.rd(), i, (op)); \
+    } \
   } \
   P.VU.vstart->write(0);
 
@@ -454,6 +458,206 @@ static inline bool is_overlapped_widen(const int astart, int asize,
   auto vs2 = P.VU.elt<float##from_width##_t>(rs2_num, i); \
   auto &vd = P.VU.elt<sign##to_width##_t>(rd_num, i, true);
 
+//
+// vector: bulk integer operation loop
+//
+// Unmasked operations that start at element 0 can skip the per-element
+// elt() bookkeeping and run BODY over the register groups' contiguous
+// bytes, which lets the host compiler vectorize it with SSE/AVX2/NEON.
+// The logged variants of each instruction always use the generic loop.
+#ifdef WORDS_BIGENDIAN
+#define VI_BULK_ELIGIBLE false
+#else
+#define VI_BULK_ELIGIBLE \
+  (!DECODE_MACRO_USAGE_LOGGED && insn.v_vm() == 1 && P.VU.vstart->read() == 0)
+#endif
+
+#define VV_BULK_SPANS(T) \
+  T *vs1_span = P.VU.elt_span<T>(rs1_num, vl); \
+  T *vs2_span = P.VU.elt_span<T>(rs2_num, vl);
+
+#define VV_BULK_PARAMS(T) \
+  T vs1 = vs1_span[i]; \
+  T UNUSED vs2 = vs2_span[i];
+
+#define VX_BULK_SPANS(T) \
+  T rs1 = (T)RS1; \
+  T *vs2_span = P.VU.elt_span<T>(rs2_num, vl);
+
+#define VX_BULK_PARAMS(T) \
+  T UNUSED vs2 = vs2_span[i];
+
+#define VI_BULK_SPANS(T) \
+  T UNUSED simm5 = (T)insn.v_simm5(); \
+  T UNUSED zimm5 = (T)insn.v_zimm5(); \
+  T *vs2_span = P.VU.elt_span<T>(rs2_num, vl);
+
+#define VI_BULK_PARAMS(T) \
+  T UNUSED vs2 = vs2_span[i];
+
+#define VI_BULK_LOOP_SEW(SPANS, PARAMS, T, BODY) \
+  { \
+    SPANS(T) \
+    T *vd_span = P.VU.elt_span<T>(rd_num, vl, true); \
+    for (reg_t i = 0; i < vl; ++i) { \
+      T UNUSED &vd = vd_span[i]; \
+      PARAMS(T) \
+      BODY; \
+    } \
+  }
+
+#define VI_BULK_CMP_LOOP_SEW(SPANS, PARAMS, T, BODY) \
+  { \
+    SPANS(T) \
+    uint8_t *vd_mask = P.VU.elt_span<uint8_t>(rd_num, (vl + 7) / 8, true); \
+    for (reg_t i = 0; i < vl; ) { \
+      const reg_t first = i; \
+      uint8_t bits = 0; \
+      for (; i < vl && i - first < 8; ++i) { \
+        PARAMS(T) \
+        bool res = false; \
+        BODY; \
+        bits |= uint8_t(res) << (i - first); \
+      } \
+      const uint8_t keep = i - first == 8 ? 0 : uint8_t(0xff << (i - first)); \
+      vd_mask[first / 8] = (vd_mask[first / 8] & keep) | bits; \
+    } \
+  }
+
+#define VI_BULK_LOOP_BASE(LOOP_SEW, SPANS, PARAMS, TYPE, BODY) \
+  require(P.VU.vsew >= e8 && P.VU.vsew <= e64); \
+  require_vector(true); \
+  reg_t vl = P.VU.vl->read(); \
+  reg_t UNUSED sew = P.VU.vsew; \
+  reg_t UNUSED rd_num = insn.rd(); \
+  reg_t UNUSED rs1_num = insn.rs1(); \
+  reg_t rs2_num = insn.rs2(); \
+  if (sew == e8) { \
+    LOOP_SEW(SPANS, PARAMS, TYPE<e8>::type, BODY) \
+  } else if (sew == e16) { \
+    LOOP_SEW(SPANS, PARAMS, TYPE<e16>::type, BODY) \
+  } else if (sew == e32) { \
+    LOOP_SEW(SPANS, PARAMS, TYPE<e32>::type, BODY) \
+  } else if (sew == e64) { \
+    LOOP_SEW(SPANS, PARAMS, TYPE<e64>::type, BODY) \
+  } \
+  P.VU.vstart->write(0);
+
+#define VI_BULK_LOOP(SPANS, PARAMS, TYPE, BODY) \
+  VI_BULK_LOOP_BASE(VI_BULK_LOOP_SEW, SPANS, PARAMS, TYPE, BODY)
+
+#define VI_BULK_CMP_LOOP(SPANS, PARAMS, TYPE, BODY) \
+  VI_BULK_LOOP_BASE(VI_BULK_CMP_LOOP_SEW, SPANS, PARAMS, TYPE, BODY)
+
+//
+// vector: word-at-a-time mask kernels
+//
+// Mask registers are read and written 64 elements at a time, mask element
+// i being bit i % 64 of word i / 64. This needs a little-endian host and a
+// register at least one word wide.
+#ifdef WORDS_BIGENDIAN
+#define VI_MASK_WORDS_ELIGIBLE false
+#else
+#define VI_MASK_WORDS_ELIGIBLE (P.VU.VLEN >= 64)
+#endif
+
+// the bits of mask word w that hold elements [start, end)
+#define VI_MASK_WORD_RANGE(w, start, end) \
+  make_mask64(std::max<reg_t>(start, (w) * 64) - (w) * 64, \
+              std::min<reg_t>(end, (w) * 64 + 64) - std::max<reg_t>(start, (w) * 64))
+
+// the elements of mask word w that are active under v0.t
+#define VI_MASK_WORD_ACTIVE(w) \
+  (insn.v_vm() == 1 ? UINT64_MAX : v0_words[w])
+
+// OP is a boolean expression of the mask bits vs2 and vs1. Its truth table
+// is evaluated once and then applied to whole words.
+#define VI_MASK_WORDS_LOGICAL(OP, start, end) \
+  if ((start) < (end)) { \
+    auto op_bit = [](bool vs2, bool vs1) -> bool { return (OP); }; \
+    const uint64_t tt11 = op_bit(true, true) ? UINT64_MAX : 0; \
+    const uint64_t tt10 = op_bit(true, false) ? UINT64_MAX : 0; \
+    const uint64_t tt01 = op_bit(false, true) ? UINT64_MAX : 0; \
+    const uint64_t tt00 = op_bit(false, false) ? UINT64_MAX : 0; \
+    const uint64_t *vs2_words = P.VU.mask_words(insn.rs2()); \
+    const uint64_t *vs1_words = P.VU.mask_words(insn.rs1()); \
+    uint64_t *vd_words = P.VU.mask_words(insn.rd(), true); \
+    for (reg_t w = (start) / 64; w * 64 < (end); ++w) { \
+      const uint64_t a = vs2_words[w], b = vs1_words[w]; \
+      const uint64_t res = (a & b & tt11) | (a & ~b & tt10) | \
+                           (~a & b & tt01) | (~a & ~b & tt00); \
+      const uint64_t upd = VI_MASK_WORD_RANGE(w, start, end); \
+      vd_words[w] = (vd_words[w] & ~upd) | (res & upd); \
+    } \
+  }
+
+// vmsbf.m, vmsif.m and vmsof.m: every active element is set by comparing
+// its index against that of the first active set element of vs2
+#define VI_MASK_WORDS_SET_FIRST(BEFORE, AT, AFTER) \
+  { \
+    const uint64_t *v0_words = P.VU.mask_words(0); \
+    const uint64_t *vs2_words = P.VU.mask_words(rs2_num); \
+    uint64_t *vd_words = P.VU.mask_words(rd_num, true); \
+    bool has_one = false; \
+    for (reg_t w = 0; w * 64 < vl; ++w) { \
+      const uint64_t active = VI_MASK_WORD_ACTIVE(w) & VI_MASK_WORD_RANGE(w, 0, vl); \
+      const uint64_t set = vs2_words[w] & active; \
+      uint64_t res; \
+      if (has_one) { \
+        res = (AFTER) ? UINT64_MAX : 0; \
+      } else if (set == 0) { \
+        res = (BEFORE) ? UINT64_MAX : 0; \
+      } else { \
+        const uint64_t at = set & -set; \
+        res = ((BEFORE) ? at - 1 : 0) | ((AT) ? at : 0) | \
+              ((AFTER) ? ~(at | (at - 1)) : 0); \
+        has_one = true; \
+      } \
+      vd_words[w] = (vd_words[w] & ~active) | (res & active); \
+    } \
+  }
+
+//
+// vector: bulk integer reduction
+//
+// Integer reductions are associative and commutative, so unmasked ones that
+// start at element 0 fold vs2 into a few independent lanes and then combine
+// the lanes pairwise. BODY folds vs2 into vd_0_res.
+#define VI_REDUCTION_COMBINE(acc, val, BODY) \
+  { \
+    auto &vd_0_res = acc; \
+    auto UNUSED vs2 = val; \
+    BODY; \
+  }
+
+#define VI_BULK_REDUCTION_LANES 4
+
+#define VI_BULK_REDUCTION_LOOP(x, TYPE, BODY) \
+  { \
+    const reg_t vl = P.VU.vl->read(); \
+    auto &vd_0_des = P.VU.elt<TYPE<x>::type>(insn.rd(), 0, true); \
+    auto red_res = P.VU.elt<TYPE<x>::type>(insn.rs1(), 0); \
+    const auto *vs2_span = P.VU.elt_span<TYPE<x>::type>(insn.rs2(), vl); \
+    TYPE<x>::type lanes[VI_BULK_REDUCTION_LANES]; \
+    for (reg_t k = 0; k < VI_BULK_REDUCTION_LANES; ++k) \
+      lanes[k] = vs2_span[k]; \
+    reg_t i = VI_BULK_REDUCTION_LANES; \
+    for (; i + VI_BULK_REDUCTION_LANES <= vl; i += VI_BULK_REDUCTION_LANES) \
+      for (reg_t k = 0; k < VI_BULK_REDUCTION_LANES; ++k) \
+        VI_REDUCTION_COMBINE(lanes[k], vs2_span[i + k], BODY) \
+    for (; i < vl; ++i) \
+      VI_REDUCTION_COMBINE(lanes[0], vs2_span[i], BODY) \
+    for (reg_t span = VI_BULK_REDUCTION_LANES / 2; span > 0; span /= 2) \
+      for (reg_t k = 0; k < span; ++k) \
+        VI_REDUCTION_COMBINE(lanes[k], lanes[k + span], BODY) \
+    VI_REDUCTION_COMBINE(red_res, lanes[0], BODY) \
+    vd_0_des = red_res; \
+    P.VU.vstart->write(0); \
+  }
+
+#define VI_BULK_REDUCTION_ELIGIBLE \
+  (VI_BULK_ELIGIBLE && P.VU.vl->read() >= VI_BULK_REDUCTION_LANES)
+
 //
 // vector: integer and masking operation loop
 //
@@ -479,29 +683,36 @@ static inline bool is_overlapped_widen(const int astart, int asize,
   INSNS_BASE(PARAMS, BODY) \
   VI_LOOP_CMP_END
 
+#define VI_LOOP_CMP_BODY_OR_BULK(PARAMS, BULK_SPANS, BULK_PARAMS, TYPE, BODY) \
+  if (VI_BULK_ELIGIBLE) { \
+    VI_BULK_CMP_LOOP(BULK_SPANS, BULK_PARAMS, TYPE, BODY) \
+  } else { \
+    VI_LOOP_CMP_BODY(PARAMS, BODY) \
+  }
+
 #define VI_VV_LOOP_CMP(BODY) \
   VI_CHECK_MSS(true); \
-  VI_LOOP_CMP_BODY(VV_CMP_PARAMS, BODY)
+  VI_LOOP_CMP_BODY_OR_BULK(VV_CMP_PARAMS, VV_BULK_SPANS, VV_BULK_PARAMS, type_sew_t, BODY)
 
 #define VI_VX_LOOP_CMP(BODY) \
   VI_CHECK_MSS(false); \
-  VI_LOOP_CMP_BODY(VX_CMP_PARAMS, BODY)
+  VI_LOOP_CMP_BODY_OR_BULK(VX_CMP_PARAMS, VX_BULK_SPANS, VX_BULK_PARAMS, type_sew_t, BODY)
 
 #define VI_VI_LOOP_CMP(BODY) \
   VI_CHECK_MSS(false); \
-  VI_LOOP_CMP_BODY(VI_CMP_PARAMS, BODY)
+  VI_LOOP_CMP_BODY_OR_BULK(VI_CMP_PARAMS, VI_BULK_SPANS, VI_BULK_PARAMS, type_sew_t, BODY)
 
 #define VI_VV_ULOOP_CMP(BODY) \
   VI_CHECK_MSS(true); \
-  VI_LOOP_CMP_BODY(VV_UCMP_PARAMS, BODY)
+  VI_LOOP_CMP_BODY_OR_BULK(VV_UCMP_PARAMS, VV_BULK_SPANS, VV_BULK_PARAMS, type_usew_t, BODY)
 
 #define VI_VX_ULOOP_CMP(BODY) \
   VI_CHECK_MSS(false); \
-  VI_LOOP_CMP_BODY(VX_UCMP_PARAMS, BODY)
+  VI_LOOP_CMP_BODY_OR_BULK(VX_UCMP_PARAMS, VX_BULK_SPANS, VX_BULK_PARAMS, type_usew_t, BODY)
 
 #define VI_VI_ULOOP_CMP(BODY) \
   VI_CHECK_MSS(false); \
-  VI_LOOP_CMP_BODY(VI_UCMP_PARAMS, BODY)
+  VI_LOOP_CMP_BODY_OR_BULK(VI_UCMP_PARAMS, VI_BULK_SPANS, VI_BULK_PARAMS, type_usew_t, BODY)
 
 // merge and copy loop
 #define VI_MERGE_VARS \
@@ -596,9 +807,13 @@ static inline bool is_overlapped_widen(const int astart, int asize,
     auto vs2 = P.VU.elt<type_sew_t<x>::type>(rs2_num, i); \
 
 #define REDUCTION_LOOP(x, BODY) \
-  VI_LOOP_REDUCTION_BASE(x) \
-  BODY; \
-  VI_LOOP_REDUCTION_END(x)
+  if (VI_BULK_REDUCTION_ELIGIBLE) { \
+    VI_BULK_REDUCTION_LOOP(x, type_sew_t, BODY) \
+  } else { \
+    VI_LOOP_REDUCTION_BASE(x) \
+    BODY; \
+    VI_LOOP_REDUCTION_END(x) \
+  }
 
 #define VI_VV_LOOP_REDUCTION(BODY) \
   VI_CHECK_REDUCTION(false); \
@@ -627,9 +842,13 @@ static inline bool is_overlapped_widen(const int astart, int asize,
     auto vs2 = P.VU.elt<type_usew_t<x>::type>(rs2_num, i);
 
 #define REDUCTION_ULOOP(x, BODY) \
-  VI_ULOOP_REDUCTION_BASE(x) \
-  BODY; \
-  VI_LOOP_REDUCTION_END(x)
+  if (VI_BULK_REDUCTION_ELIGIBLE) { \
+    VI_BULK_REDUCTION_LOOP(x, type_usew_t, BODY) \
+  } else { \
+    VI_ULOOP_REDUCTION_BASE(x) \
+    BODY; \
+    VI_LOOP_REDUCTION_END(x) \
+  }
 
 #define VI_VV_ULOOP_REDUCTION(BODY) \
   VI_CHECK_REDUCTION(false); \
@@ -647,6 +866,9 @@ static inline bool is_overlapped_widen(const int astart, int asize,
 // genearl VXI signed/unsigned loop
 #define VI_VV_ULOOP(BODY) \
   VI_CHECK_SSS(true) \
+  if (VI_BULK_ELIGIBLE) { \
+    VI_BULK_LOOP(VV_BULK_SPANS, VV_BULK_PARAMS, type_usew_t, BODY) \
+  } else { \
   VI_LOOP_BASE \
   if (sew == e8) { \
     VV_U_PARAMS(e8); \
@@ -661,10 +883,14 @@ static inline bool is_overlapped_widen(const int astart, int asize,
     VV_U_PARAMS(e64); \
     BODY; \
   } \
-  VI_LOOP_END 
+  VI_LOOP_END \
+  }
 
 #define VI_VV_LOOP(BODY) \
   VI_CHECK_SSS(true) \
+  if (VI_BULK_ELIGIBLE) { \
+    VI_BULK_LOOP(VV_BULK_SPANS, VV_BULK_PARAMS, type_sew_t, BODY) \
+  } else { \
   VI_LOOP_BASE \
   if (sew == e8) { \
     VV_PARAMS(e8); \
@@ -679,7 +905,8 @@ static inline bool is_overlapped_widen(const int astart, int asize,
     VV_PARAMS(e64); \
     BODY; \
   } \
-  VI_LOOP_END 
+  VI_LOOP_END \
+  }
 
 #define VI_V_ULOOP(BODY) \
   VI_CHECK_SSS(false) \
@@ -701,6 +928,9 @@ static inline bool is_overlapped_widen(const int astart, int asize,
 
 #define VI_VX_ULOOP(BODY) \
   VI_CHECK_SSS(false) \
+  if (VI_BULK_ELIGIBLE) { \
+    VI_BULK_LOOP(VX_BULK_SPANS, VX_BULK_PARAMS, type_usew_t, BODY) \
+  } else { \
   VI_LOOP_BASE \
   if (sew == e8) { \
     VX_U_PARAMS(e8); \
@@ -715,10 +945,14 @@ static inline bool is_overlapped_widen(const int astart, int asize,
     VX_U_PARAMS(e64); \
     BODY; \
   } \
-  VI_LOOP_END 
+  VI_LOOP_END \
+  }
 
 #define VI_VX_LOOP(BODY) \
   VI_CHECK_SSS(false) \
+  if (VI_BULK_ELIGIBLE) { \
+    VI_BULK_LOOP(VX_BULK_SPANS, VX_BULK_PARAMS, type_sew_t, BODY) \
+  } else { \
   VI_LOOP_BASE \
   if (sew == e8) { \
     VX_PARAMS(e8); \
@@ -733,10 +967,14 @@ static inline bool is_overlapped_widen(const int astart, int asize,
     VX_PARAMS(e64); \
     BODY; \
   } \
-  VI_LOOP_END 
+  VI_LOOP_END \
+  }
 
 #define VI_VI_ULOOP(BODY) \
   VI_CHECK_SSS(false) \
+  if (VI_BULK_ELIGIBLE) { \
+    VI_BULK_LOOP(VI_BULK_SPANS, VI_BULK_PARAMS, type_usew_t, BODY) \
+  } else { \
   VI_LOOP_BASE \
   if (sew == e8) { \
     VI_U_PARAMS(e8); \
@@ -751,10 +989,14 @@ static inline bool is_overlapped_widen(const int astart, int asize,
     VI_U_PARAMS(e64); \
     BODY; \
   } \
-  VI_LOOP_END 
+  VI_LOOP_END \
+  }
 
 #define VI_VI_LOOP(BODY) \
   VI_CHECK_SSS(false) \
+  if (VI_BULK_ELIGIBLE) { \
+    VI_BULK_LOOP(VI_BULK_SPANS, VI_BULK_PARAMS, type_sew_t, BODY) \
+  } else { \
   VI_LOOP_BASE \
   if (sew == e8) { \
     VI_PARAMS(e8); \
@@ -769,7 +1011,8 @@ static inline bool is_overlapped_widen(const int astart, int asize,
     VI_PARAMS(e64); \
     BODY; \
   } \
-  VI_LOOP_END 
+  VI_LOOP_END \
+  }
 
 // signed unsigned operation loop (e.g. mulhsu)
 #define VI_VV_SU_LOOP(BODY) \
@@ -1162,12 +1405,19 @@ VI_VX_ULOOP({ \
 #define VI_STRIP(inx) \
   reg_t vreg_inx = inx;
 
-#define VI_LD(stride, offset, elt_width, is_mask_ldst) \
+// unmasked unit-stride accesses that start at element 0 and are aligned
+// to the element size may be copied in bulk through host pointers
+#define VI_LDST_BULK_ELIGIBLE(elt_width) \
+  (VI_BULK_ELIGIBLE && (baseAddr & (sizeof(elt_width##_t) - 1)) == 0)
+
+#define VI_LD_PROLOGUE(elt_width, is_mask_ldst) \
   const reg_t nf = insn.v_nf() + 1; \
   VI_CHECK_LOAD(elt_width, is_mask_ldst); \
   const reg_t vl = is_mask_ldst ? ((P.VU.vl->read() + 7) / 8) : P.VU.vl->read(); \
   const reg_t baseAddr = RS1; \
-  const reg_t vd = insn.rd(); \
+  const reg_t vd = insn.rd();
+
+#define VI_LD_LOOP(stride, offset, elt_width) \
   for (reg_t i = 0; i < vl; ++i) { \
     VI_ELEMENT_SKIP; \
     VI_STRIP(i); \
@@ -1177,6 +1427,18 @@ VI_VX_ULOOP({ \
         baseAddr + (stride) + (offset) * sizeof(elt_width##_t)); \
       P.VU.elt<elt_width##_t>(vd + fn * emul, vreg_inx, true) = val; \
     } \
+  }
+
+#define VI_LD(stride, offset, elt_width, is_mask_ldst) \
+  VI_LD_PROLOGUE(elt_width, is_mask_ldst) \
+  VI_LD_LOOP(stride, offset, elt_width) \
+  P.VU.vstart->write(0);
+
+#define VI_LD_UNIT_STRIDE(elt_width, is_mask_ldst) \
+  VI_LD_PROLOGUE(elt_width, is_mask_ldst) \
+  if (!(VI_LDST_BULK_ELIGIBLE(elt_width) && \
+        P.VU.load_unit_stride_bulk(vd, baseAddr, vl, nf, emul, sizeof(elt_width##_t)))) { \
+    VI_LD_LOOP(0, (i * nf + fn), elt_width) \
   } \
   P.VU.vstart->write(0);
 
@@ -1233,12 +1495,14 @@ VI_VX_ULOOP({ \
   } \
   P.VU.vstart->write(0);
 
-#define VI_ST(stride, offset, elt_width, is_mask_ldst) \
+#define VI_ST_PROLOGUE(elt_width, is_mask_ldst) \
   const reg_t nf = insn.v_nf() + 1; \
   VI_CHECK_STORE(elt_width, is_mask_ldst); \
   const reg_t vl = is_mask_ldst ? ((P.VU.vl->read() + 7) / 8) : P.VU.vl->read(); \
   const reg_t baseAddr = RS1; \
-  const reg_t vs3 = insn.rd(); \
+  const reg_t vs3 = insn.rd();
+
+#define VI_ST_LOOP(stride, offset, elt_width) \
   for (reg_t i = 0; i < vl; ++i) { \
     VI_STRIP(i) \
     VI_ELEMENT_SKIP; \
@@ -1248,6 +1512,18 @@ VI_VX_ULOOP({ \
       MMU.store<elt_width##_t>( \
         baseAddr + (stride) + (offset) * sizeof(elt_width##_t), val); \
     } \
+  }
+
+#define VI_ST(stride, offset, elt_width, is_mask_ldst) \
+  VI_ST_PROLOGUE(elt_width, is_mask_ldst) \
+  VI_ST_LOOP(stride, offset, elt_width) \
+  P.VU.vstart->write(0);
+
+#define VI_ST_UNIT_STRIDE(elt_width, is_mask_ldst) \
+  VI_ST_PROLOGUE(elt_width, is_mask_ldst) \
+  if (!(VI_LDST_BULK_ELIGIBLE(elt_width) && \
+        P.VU.store_unit_stride_bulk(vs3, baseAddr, vl, nf, emul, sizeof(elt_width##_t)))) { \
+    VI_ST_LOOP(0, (i * nf + fn), elt_width) \
   } \
   P.VU.vstart->write(0);
 
@@ -1329,7 +1605,9 @@ VI_VX_ULOOP({ \
   require_align(vd, len); \
   const reg_t elt_per_reg = P.VU.vlenb / sizeof(elt_width ## _t); \
   const reg_t size = len * elt_per_reg; \
-  if (P.VU.vstart->read() < size) { \
+  if (P.VU.vstart->read() < size && \
+      !(VI_LDST_BULK_ELIGIBLE(elt_width) && \
+        P.VU.load_unit_stride_bulk(vd, baseAddr, size, 1, len, sizeof(elt_width##_t)))) { \
     reg_t i = P.VU.vstart->read() / elt_per_reg; \
     reg_t off = P.VU.vstart->read() % elt_per_reg; \
     if (off) { \
@@ -1360,7 +1638,9 @@ VI_VX_ULOOP({ \
   require_align(vs3, len); \
   const reg_t size = len * P.VU.vlenb; \
   \
-  if (P.VU.vstart->read() < size) { \
+  if (P.VU.vstart->read() < size && \
+      !(VI_LDST_BULK_ELIGIBLE(uint8) && \
+        P.VU.store_unit_stride_bulk(vs3, baseAddr, size, 1, len, 1))) { \
     reg_t i = P.VU.vstart->read() / P.VU.vlenb; \
     reg_t off = P.VU.vstart->read() % P.VU.vlenb; \
     if (off) { \
@@ -1551,34 +1831,158 @@ VI_VX_ULOOP({ \
   } \
   P.VU.vstart->write(0);
 
-#define VI_VFP_VV_LOOP(BODY16, BODY32, BODY64) \
-  VI_CHECK_SSS(true); \
-  VI_VFP_LOOP_BASE \
+//
+// vector: bulk floating-point operation loop
+//
+// Like the integer bulk loops, unmasked operations that start at element 0
+// walk the register groups directly. The accrued exception flags are
+// sticky, so they are collected across the whole instruction and written to
+// fflags once rather than after every element.
+#define VFP_VV_BULK_SPANS(width) \
+  VV_BULK_SPANS(float##width##_t)
+
+#define VFP_VV_BULK_PARAMS(width) \
+  VV_BULK_PARAMS(float##width##_t)
+
+#define VFP_VF_BULK_SPANS(width) \
+  float##width##_t rs1 = f##width(READ_FREG(rs1_num)); \
+  float##width##_t *vs2_span = P.VU.elt_span<float##width##_t>(rs2_num, vl);
+
+#define VFP_VF_BULK_PARAMS(width) \
+  VX_BULK_PARAMS(float##width##_t)
+
+#define VI_VFP_BULK_LOOP_SEW(SPANS, PARAMS, width, BODY) \
+  { \
+    SPANS(width) \
+    float##width##_t *vd_span = P.VU.elt_span<float##width##_t>(rd_num, vl, true); \
+    for (reg_t i = 0; i < vl; ++i) { \
+      float##width##_t &vd = vd_span[i]; \
+      PARAMS(width) \
+      BODY; \
+    } \
+  }
+
+#define VI_VFP_BULK_LOOP(SPANS, PARAMS, BODY16, BODY32, BODY64) \
+  VI_VFP_COMMON \
   switch (P.VU.vsew) { \
-    case e16: { \
-      VFP_VV_PARAMS(16); \
-      BODY16; \
-      set_fp_exceptions; \
+    case e16: \
+      VI_VFP_BULK_LOOP_SEW(SPANS, PARAMS, 16, BODY16); \
       break; \
-    } \
-    case e32: { \
-      VFP_VV_PARAMS(32); \
-      BODY32; \
-      set_fp_exceptions; \
+    case e32: \
+      VI_VFP_BULK_LOOP_SEW(SPANS, PARAMS, 32, BODY32); \
       break; \
-    } \
-    case e64: { \
-      VFP_VV_PARAMS(64); \
-      BODY64; \
-      set_fp_exceptions; \
+    case e64: \
+      VI_VFP_BULK_LOOP_SEW(SPANS, PARAMS, 64, BODY64); \
       break; \
-    } \
     default: \
       require(0); \
       break; \
-  }; \
-  DEBUG_RVV_FP_VV; \
-  VI_VFP_LOOP_END
+  } \
+  set_fp_exceptions; \
+  P.VU.vstart->write(0);
+
+//
+// vector: host-FPU batched floating-point loop
+//
+// With --host-fpu, simple single- and double-precision arithmetic in
+// round-to-nearest-even is computed a batch at a time by host_fpu_batch(),
+// which falls back to BODY (softfloat) for batches the host can't match
+// bit-for-bit. HOST_EXPR is written in terms of host float/double values
+// named vs1, vs2 and rs1.
+#define VI_VFP_HOST_ELIGIBLE \
+  (VI_BULK_ELIGIBLE && HOST_FPU_SUPPORTED && p->get_cfg().host_fpu && \
+   STATE.frm->read() == softfloat_round_near_even && \
+   (P.VU.vsew == e32 || P.VU.vsew == e64))
+
+#define VFP_VV_BULK_HOST_SPANS(width) \
+  VFP_VV_BULK_SPANS(width)
+
+#define VFP_VV_BULK_HOST_OPERANDS(width) \
+  (host_fpu_operand_ok(vs1_span[i]) && host_fpu_operand_ok(vs2_span[i]))
+
+#define VFP_VV_BULK_HOST_PARAMS(width) \
+  auto UNUSED vs1 = host_fpu_to_host(vs1_span[i]); \
+  auto UNUSED vs2 = host_fpu_to_host(vs2_span[i]);
+
+#define VFP_VF_BULK_HOST_SPANS(width) \
+  VFP_VF_BULK_SPANS(width) \
+  auto rs1_host = host_fpu_to_host(rs1);
+
+#define VFP_VF_BULK_HOST_OPERANDS(width) \
+  (host_fpu_operand_ok(rs1) && host_fpu_operand_ok(vs2_span[i]))
+
+#define VFP_VF_BULK_HOST_PARAMS(width) \
+  auto UNUSED rs1 = rs1_host; \
+  auto UNUSED vs2 = host_fpu_to_host(vs2_span[i]);
+
+#define VI_VFP_HOST_LOOP_SEW(KIND, width, HOST_EXPR, BODY) \
+  { \
+    VFP_##KIND##_BULK_HOST_SPANS(width) \
+    float##width##_t *vd_span = P.VU.elt_span<float##width##_t>(rd_num, vl, true); \
+    host_fpu_batch(vd_span, vl, \
+      [&](reg_t i) { return VFP_##KIND##_BULK_HOST_OPERANDS(width); }, \
+      [&](reg_t i) { VFP_##KIND##_BULK_HOST_PARAMS(width) return HOST_EXPR; }, \
+      [&](reg_t i) { \
+        float##width##_t vd = vd_span[i]; \
+        VFP_##KIND##_BULK_PARAMS(width) \
+        BODY; \
+        return vd; \
+      }); \
+  }
+
+#define VI_VFP_HOST_LOOP(KIND, HOST_EXPR, BODY16, BODY32, BODY64) \
+  if (VI_VFP_HOST_ELIGIBLE) { \
+    VI_VFP_COMMON \
+    if (P.VU.vsew == e32) \
+      VI_VFP_HOST_LOOP_SEW(KIND, 32, HOST_EXPR, BODY32) \
+    else \
+      VI_VFP_HOST_LOOP_SEW(KIND, 64, HOST_EXPR, BODY64) \
+    set_fp_exceptions; \
+    P.VU.vstart->write(0); \
+  } else { \
+    VI_VFP_##KIND##_LOOP(BODY16, BODY32, BODY64) \
+  }
+
+#define VI_VFP_VV_LOOP_HOST(HOST_EXPR, BODY16, BODY32, BODY64) \
+  VI_CHECK_SSS(true); \
+  VI_VFP_HOST_LOOP(VV, HOST_EXPR, BODY16, BODY32, BODY64)
+
+#define VI_VFP_VF_LOOP_HOST(HOST_EXPR, BODY16, BODY32, BODY64) \
+  VI_CHECK_SSS(false); \
+  VI_VFP_HOST_LOOP(VF, HOST_EXPR, BODY16, BODY32, BODY64)
+
+#define VI_VFP_VV_LOOP(BODY16, BODY32, BODY64) \
+  VI_CHECK_SSS(true); \
+  if (VI_BULK_ELIGIBLE) { \
+    VI_VFP_BULK_LOOP(VFP_VV_BULK_SPANS, VFP_VV_BULK_PARAMS, BODY16, BODY32, BODY64) \
+  } else { \
+    VI_VFP_LOOP_BASE \
+    switch (P.VU.vsew) { \
+      case e16: { \
+        VFP_VV_PARAMS(16); \
+        BODY16; \
+        set_fp_exceptions; \
+        break; \
+      } \
+      case e32: { \
+        VFP_VV_PARAMS(32); \
+        BODY32; \
+        set_fp_exceptions; \
+        break; \
+      } \
+      case e64: { \
+        VFP_VV_PARAMS(64); \
+        BODY64; \
+        set_fp_exceptions; \
+        break; \
+      } \
+      default: \
+        require(0); \
+        break; \
+    }; \
+    DEBUG_RVV_FP_VV; \
+    VI_VFP_LOOP_END \
+  }
 
 #define VI_VFP_V_LOOP(BODY16, BODY32, BODY64) \
   VI_CHECK_SSS(false); \
@@ -1672,32 +2076,36 @@ VI_VX_ULOOP({ \
 
 #define VI_VFP_VF_LOOP(BODY16, BODY32, BODY64) \
   VI_CHECK_SSS(false); \
-  VI_VFP_LOOP_BASE \
-  switch (P.VU.vsew) { \
-    case e16: { \
-      VFP_VF_PARAMS(16); \
-      BODY16; \
-      set_fp_exceptions; \
-      break; \
-    } \
-    case e32: { \
-      VFP_VF_PARAMS(32); \
-      BODY32; \
-      set_fp_exceptions; \
-      break; \
-    } \
-    case e64: { \
-      VFP_VF_PARAMS(64); \
-      BODY64; \
-      set_fp_exceptions; \
-      break; \
-    } \
-    default: \
-      require(0); \
-      break; \
-  }; \
-  DEBUG_RVV_FP_VF; \
-  VI_VFP_LOOP_END
+  if (VI_BULK_ELIGIBLE) { \
+    VI_VFP_BULK_LOOP(VFP_VF_BULK_SPANS, VFP_VF_BULK_PARAMS, BODY16, BODY32, BODY64) \
+  } else { \
+    VI_VFP_LOOP_BASE \
+    switch (P.VU.vsew) { \
+      case e16: { \
+        VFP_VF_PARAMS(16); \
+        BODY16; \
+        set_fp_exceptions; \
+        break; \
+      } \
+      case e32: { \
+        VFP_VF_PARAMS(32); \
+        BODY32; \
+        set_fp_exceptions; \
+        break; \
+      } \
+      case e64: { \
+        VFP_VF_PARAMS(64); \
+        BODY64; \
+        set_fp_exceptions; \
+        break; \
+      } \
+      default: \
+        require(0); \
+        break; \
+    }; \
+    DEBUG_RVV_FP_VF; \
+    VI_VFP_LOOP_END \
+  }
 
 #define VI_VFP_VV_LOOP_CMP(BODY16, BODY32, BODY64) \
   VI_CHECK_MSS(true); \
@@ -3,6 +3,7 @@
 #include "config.h"
 #include "vector_unit.h"
 #include "processor.h"
+#include "mmu.h"
 #include "arith.h"
 
 void vectorUnit_t::vectorUnit_t::reset()
@@ -88,6 +89,59 @@ template<class T> T& vectorUnit_t::elt(reg_t vReg, reg_t n, bool UNUSED is_write
   return regStart[n];
 }
 
+// Unlike 'elt()', 'elt_span()' is only meaningful on little-endian hosts,
+// where consecutive elements of a register group are consecutive in memory.
+template<class T> T* vectorUnit_t::elt_span(reg_t vReg, reg_t n, bool UNUSED is_write) {
+  assert(vsew != 0);
+  const reg_t bytes_per_reg = VLEN >> 3;
+  const reg_t reg_last = vReg + (std::max(n, reg_t(1)) * sizeof(T) - 1) / bytes_per_reg;
+  assert(reg_last < NVPR);
+
+  for (reg_t vidx = vReg; vidx <= reg_last; ++vidx) {
+    reg_referenced[vidx] = 1;
+
+    if (unlikely(p->get_log_commits_enabled() && is_write))
+      p->get_state()->log_reg_write[(vidx << 4) | 2] = {0, 0};
+  }
+
+  return (T*)((char*)reg_file + vReg * bytes_per_reg);
+}
+
+bool vectorUnit_t::load_unit_stride_bulk(reg_t vReg, reg_t addr, reg_t vl, reg_t nf, reg_t emul, reg_t elt_bytes)
+{
+  mmu_t* mmu = p->get_mmu();
+  if (nf == 1)
+    return mmu->load_bulk(addr, vl * elt_bytes, elt_span<uint8_t>(vReg, vl * elt_bytes, true));
+
+  std::vector<uint8_t> segs(vl * nf * elt_bytes);
+  if (!mmu->load_bulk(addr, segs.size(), segs.data()))
+    return false;
+
+  for (reg_t fn = 0; fn < nf; ++fn) {
+    uint8_t* field = elt_span<uint8_t>(vReg + fn * emul, vl * elt_bytes, true);
+    for (reg_t i = 0; i < vl; ++i)
+      memcpy(field + i * elt_bytes, &segs[(i * nf + fn) * elt_bytes], elt_bytes);
+  }
+
+  return true;
+}
+
+bool vectorUnit_t::store_unit_stride_bulk(reg_t vReg, reg_t addr, reg_t vl, reg_t nf, reg_t emul, reg_t elt_bytes)
+{
+  mmu_t* mmu = p->get_mmu();
+  if (nf == 1)
+    return mmu->store_bulk(addr, vl * elt_bytes, elt_span<uint8_t>(vReg, vl * elt_bytes));
+
+  std::vector<uint8_t> segs(vl * nf * elt_bytes);
+  for (reg_t fn = 0; fn < nf; ++fn) {
+    const uint8_t* field = elt_span<uint8_t>(vReg + fn * emul, vl * elt_bytes);
+    for (reg_t i = 0; i < vl; ++i)
+      memcpy(&segs[(i * nf + fn) * elt_bytes], field + i * elt_bytes, elt_bytes);
+  }
+
+  return mmu->store_bulk(addr, segs.size(), segs.data());
+}
+
 // The logic differences between 'elt()' and 'elt_group()' come from
 // the fact that, while 'elt()' requires that the element is fully
 // contained in a single vector register, the element group may span
@@ -151,6 +205,18 @@ template float16_t& vectorUnit_t::elt<float16_t>(reg_t, reg_t, bool);
 template float32_t& vectorUnit_t::elt<float32_t>(reg_t, reg_t, bool);
 template float64_t& vectorUnit_t::elt<float64_t>(reg_t, reg_t, bool);
 
+template int8_t* vectorUnit_t::elt_span<int8_t>(reg_t, reg_t, bool);
+template int16_t* vectorUnit_t::elt_span<int16_t>(reg_t, reg_t, bool);
+template int32_t* vectorUnit_t::elt_span<int32_t>(reg_t, reg_t, bool);
+template int64_t* vectorUnit_t::elt_span<int64_t>(reg_t, reg_t, bool);
+template uint8_t* vectorUnit_t::elt_span<uint8_t>(reg_t, reg_t, bool);
+template uint16_t* vectorUnit_t::elt_span<uint16_t>(reg_t, reg_t, bool);
+template uint32_t* vectorUnit_t::elt_span<uint32_t>(reg_t, reg_t, bool);
+template uint64_t* vectorUnit_t::elt_span<uint64_t>(reg_t, reg_t, bool);
+template float16_t* vectorUnit_t::elt_span<float16_t>(reg_t, reg_t, bool);
+template float32_t* vectorUnit_t::elt_span<float32_t>(reg_t, reg_t, bool);
+template float64_t* vectorUnit_t::elt_span<float64_t>(reg_t, reg_t, bool);
+
 template EGU32x4_t& vectorUnit_t::elt_group<EGU32x4_t>(reg_t, reg_t, bool);
 template EGU32x8_t& vectorUnit_t::elt_group<EGU32x8_t>(reg_t, reg_t, bool);
 template EGU64x4_t& vectorUnit_t::elt_group<EGU64x4_t>(reg_t, reg_t, bool);
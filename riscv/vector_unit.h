@@ -107,6 +107,21 @@ public:
   // vector element group access, where EG is a std::array<T, N>.
   template<typename EG> EG&
   elt_group(reg_t vReg, reg_t n, bool is_write = false);
+  // the first n elements of the register group at vReg, as a host array
+  template<class T> T* elt_span(reg_t vReg, reg_t n, bool is_write = false);
+  // unit-stride accesses of vl segments of nf fields, each field elt_bytes
+  // wide and held in the register group at vReg + field * emul. These copy
+  // straight between guest memory and the register file, and return false
+  // without touching anything if the MMU can't service the whole span.
+  bool load_unit_stride_bulk(reg_t vReg, reg_t addr, reg_t vl, reg_t nf, reg_t emul, reg_t elt_bytes);
+  bool store_unit_stride_bulk(reg_t vReg, reg_t addr, reg_t vl, reg_t nf, reg_t emul, reg_t elt_bytes);
+
+  // the mask register vReg as host words, mask element n being bit n % 64
+  // of word n / 64. Only meaningful on little-endian hosts with VLEN >= 64.
+  uint64_t* mask_words(reg_t vReg, bool is_write = false)
+  {
+    return elt_span<uint64_t>(vReg, VLEN / 64, is_write);
+  }
 
   bool mask_elt(reg_t vReg, reg_t n)
   {
@@ -40,10 +40,14 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "internals.h"
 #include "softfloat.h"
 
-float16_t
- softfloat_roundPackToF16( bool sign, int_fast16_t exp, uint_fast16_t sig )
+/*----------------------------------------------------------------------------
+| The rounding logic, with the rounding mode as a parameter so that the
+| dispatcher below can instantiate it with a compile-time constant.
+*----------------------------------------------------------------------------*/
+static inline __attribute__((always_inline)) float16_t
+ roundPackToF16(
+     bool sign, int_fast16_t exp, uint_fast16_t sig, uint_fast8_t roundingMode )
 {
-    uint_fast8_t roundingMode;
     bool roundNearEven;
     uint_fast8_t roundIncrement, roundBits;
     bool isTiny;
@@ -52,7 +56,6 @@ float16_t
 
     /*------------------------------------------------------------------------
     *------------------------------------------------------------------------*/
-    roundingMode = softfloat_roundingMode;
     roundNearEven = (roundingMode == softfloat_round_near_even);
     roundIncrement = 0x8;
     if ( ! roundNearEven && (roundingMode != softfloat_round_near_maxMag) ) {
@@ -111,3 +114,19 @@ float16_t
 
 }
 
+float16_t
+ softfloat_roundPackToF16( bool sign, int_fast16_t exp, uint_fast16_t sig )
+{
+    uint_fast8_t roundingMode;
+
+    /*------------------------------------------------------------------------
+    | Round-to-nearest-even is by far the most common mode, so it gets its
+    | own copy of the rounding logic with every mode test folded away.
+    *------------------------------------------------------------------------*/
+    roundingMode = softfloat_roundingMode;
+    if ( roundingMode == softfloat_round_near_even ) {
+        return roundPackToF16( sign, exp, sig, softfloat_round_near_even );
+    }
+    return roundPackToF16( sign, exp, sig, roundingMode );
+
+}
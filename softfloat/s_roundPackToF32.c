@@ -40,10 +40,14 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "internals.h"
 #include "softfloat.h"
 
-float32_t
- softfloat_roundPackToF32( bool sign, int_fast16_t exp, uint_fast32_t sig )
+/*----------------------------------------------------------------------------
+| The rounding logic, with the rounding mode as a parameter so that the
+| dispatcher below can instantiate it with a compile-time constant.
+*----------------------------------------------------------------------------*/
+static inline __attribute__((always_inline)) float32_t
+ roundPackToF32(
+     bool sign, int_fast16_t exp, uint_fast32_t sig, uint_fast8_t roundingMode )
 {
-    uint_fast8_t roundingMode;
     bool roundNearEven;
     uint_fast8_t roundIncrement, roundBits;
     bool isTiny;
@@ -52,7 +56,6 @@ float32_t
 
     /*------------------------------------------------------------------------
     *------------------------------------------------------------------------*/
-    roundingMode = softfloat_roundingMode;
     roundNearEven = (roundingMode == softfloat_round_near_even);
     roundIncrement = 0x40;
     if ( ! roundNearEven && (roundingMode != softfloat_round_near_maxMag) ) {
@@ -111,3 +114,19 @@ float32_t
 
 }
 
+float32_t
+ softfloat_roundPackToF32( bool sign, int_fast16_t exp, uint_fast32_t sig )
+{
+    uint_fast8_t roundingMode;
+
+    /*------------------------------------------------------------------------
+    | Round-to-nearest-even is by far the most common mode, so it gets its
+    | own copy of the rounding logic with every mode test folded away.
+    *------------------------------------------------------------------------*/
+    roundingMode = softfloat_roundingMode;
+    if ( roundingMode == softfloat_round_near_even ) {
+        return roundPackToF32( sign, exp, sig, softfloat_round_near_even );
+    }
+    return roundPackToF32( sign, exp, sig, roundingMode );
+
+}
@@ -3,12 +3,25 @@
 // This little program finds occurrences of strings like
 //   core   0: 0x000000008000c36c (0xfe843783) ld      a5, -24(s0)
 // in its inputs, then output the RISC-V instruction with the disassembly
-// enclosed hexadecimal number.
+// enclosed hexadecimal number. With --histogram, it instead prints how
+// many times each instruction occurs, most frequent first.
+//
+// The input is read from stdin, mapped into memory if it is a file, and
+// disassembled by several threads in chunks of whole lines.
 
+#include <algorithm>
 #include <iostream>
 #include <string>
+#include <cerrno>
 #include <cstdint>
-#include <regex>
+#include <cinttypes>
+#include <cstring>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "fesvr/option_parser.h"
 
 #include "disasm.h"
@@ -17,15 +30,184 @@
 
 using namespace std;
 
+typedef unordered_map<const disasm_insn_t*, uint64_t> histogram_t;
+
+static bool is_space(char c)
+{
+  return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+static int hex_digit(char c)
+{
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  c |= 0x20;
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  return -1;
+}
+
+static bool skip_spaces(const char*& p, const char* end)
+{
+  const char* start = p;
+  while (p < end && is_space(*p))
+    p++;
+  return p != start;
+}
+
+static bool skip_hex_prefix(const char*& p, const char* end)
+{
+  if (end - p < 2 || p[0] != '0' || (p[1] | 0x20) != 'x')
+    return false;
+  p += 2;
+  return true;
+}
+
+// Matches the line [p, end) against
+//   ^core\s+\d+:\s+0x[0-9a-f]+\s+\(0x([0-9a-f]+)\)
+// case-insensitively, and returns the parenthesized number in opcode.
+static bool match_line(const char* p, const char* end, uint64_t* opcode)
+{
+  if (end - p < 4 || (p[0] | 0x20) != 'c' || (p[1] | 0x20) != 'o' ||
+      (p[2] | 0x20) != 'r' || (p[3] | 0x20) != 'e')
+    return false;
+  p += 4;
+
+  if (!skip_spaces(p, end))
+    return false;
+  const char* digits = p;
+  while (p < end && *p >= '0' && *p <= '9')
+    p++;
+  if (p == digits || p == end || *p++ != ':')
+    return false;
+
+  if (!skip_spaces(p, end) || !skip_hex_prefix(p, end))
+    return false;
+  digits = p;
+  while (p < end && hex_digit(*p) >= 0)
+    p++;
+  if (p == digits)
+    return false;
+
+  if (!skip_spaces(p, end) || p == end || *p++ != '(' || !skip_hex_prefix(p, end))
+    return false;
+
+  // like strtoull, saturate on overflow; then keep as many bits as digits
+  uint64_t val = 0;
+  size_t bit_num = 0;
+  bool overflow = false;
+  for (int d; p < end && (d = hex_digit(*p)) >= 0; p++, bit_num += 4) {
+    overflow |= val >> 60;
+    val = val << 4 | d;
+  }
+  if (bit_num == 0 || p == end || *p != ')')
+    return false;
+
+  if (overflow)
+    val = UINT64_MAX;
+  if (bit_num < 64)
+    val = val << (64 - bit_num) >> (64 - bit_num);
+  *opcode = val;
+  return true;
+}
+
+// Disassembles the lines in [p, end) into out, or counts them in histogram
+static void parse_lines(const disassembler_t* disassembler, const char* p, const char* end,
+                        string* out, histogram_t* histogram)
+{
+  // most logs are dominated by a few thousand distinct instructions
+  const size_t cache_size = 4096;
+  vector<pair<uint64_t, const disasm_insn_t*>> cache(cache_size, {UINT64_MAX, nullptr});
+
+  while (p < end) {
+    const char* eol = (const char*)memchr(p, '\n', end - p);
+    if (!eol)
+      eol = end;
+
+    uint64_t opcode;
+    if (match_line(p, eol, &opcode)) {
+      auto& entry = cache[(opcode ^ (opcode >> 12)) % cache_size];
+      if (entry.first != opcode)
+        entry = {opcode, disassembler->lookup(opcode)};
+
+      if (histogram) {
+        (*histogram)[entry.second]++;
+      } else if (entry.second) {
+        *out += entry.second->get_name();
+        *out += '\n';
+      } else {
+        *out += "unknown_op\n";
+      }
+    }
+
+    p = eol + 1;
+  }
+}
+
+// Splits [p, end) at line boundaries among the threads, and prints their
+// output in order
+static void parse_chunk(const disassembler_t* disassembler, const char* p, const char* end,
+                        size_t nthreads, histogram_t* histogram)
+{
+  vector<const char*> bounds(1, p);
+  for (size_t i = 1; i < nthreads; i++) {
+    const char* split = max(bounds.back(), p + (end - p) * i / nthreads);
+    const char* eol = (const char*)memchr(split, '\n', end - split);
+    bounds.push_back(eol ? eol + 1 : end);
+  }
+  bounds.push_back(end);
+
+  vector<string> out(nthreads);
+  vector<histogram_t> histograms(nthreads);
+  vector<thread> threads;
+  for (size_t i = 0; i < nthreads; i++) {
+    threads.emplace_back(parse_lines, disassembler, bounds[i], bounds[i + 1],
+                         &out[i], histogram ? &histograms[i] : nullptr);
+  }
+
+  for (size_t i = 0; i < nthreads; i++) {
+    threads[i].join();
+    if (histogram) {
+      for (auto& item : histograms[i])
+        (*histogram)[item.first] += item.second;
+    } else {
+      fwrite(out[i].data(), 1, out[i].size(), stdout);
+    }
+  }
+}
+
+static void print_histogram(const histogram_t& histogram)
+{
+  // several disassembler entries can share a name (e.g. ret, jal, rev8)
+  unordered_map<string, uint64_t> by_name;
+  uint64_t total = 0;
+  for (auto& item : histogram) {
+    by_name[item.first ? item.first->get_name() : "unknown_op"] += item.second;
+    total += item.second;
+  }
+
+  vector<pair<string, uint64_t>> counts(by_name.begin(), by_name.end());
+
+  sort(counts.begin(), counts.end(), [](const auto& a, const auto& b) {
+    return a.second != b.second ? a.second > b.second : a.first < b.first;
+  });
+
+  for (auto& item : counts) {
+    printf("%12" PRIu64 " %6.2f%% %s\n", item.second,
+           100.0 * item.second / total, item.first.c_str());
+  }
+}
+
 int main(int UNUSED argc, char** argv)
 {
-  string s;
   const char* isa_string = DEFAULT_ISA;
+  bool histogram_mode = false;
 
   std::function<extension_t*()> extension;
   option_parser_t parser;
   parser.option(0, "extension", 1, [&](const char* s){extension = find_extension(s);});
   parser.option(0, "isa", 1, [&](const char* s){isa_string = s;});
+  parser.option(0, "histogram", 0, [&](const char UNUSED *s){histogram_mode = true;});
   parser.parse(argv);
 
   cfg_t cfg;
@@ -36,28 +218,60 @@ int main(int UNUSED argc, char** argv)
     p.register_extension(extension());
   }
 
-  std::regex reg("^core\\s+\\d+:\\s+0x[0-9a-f]+\\s+\\(0x([0-9a-f]+)\\)", std::regex_constants::icase);
-  std::smatch m;
+  const disassembler_t* disassembler = p.get_disassembler();
+  const size_t nthreads = max(1U, thread::hardware_concurrency());
+  const size_t chunk_size = size_t(64) << 20;
+  histogram_t histogram;
+  histogram_t* hist = histogram_mode ? &histogram : nullptr;
 
-  while (getline(cin,s)){
-    if (regex_search(s, m, reg)){
-      // the opcode string
-      string op = m[1].str();
-      uint32_t bit_num = op.size() * 4;
-      uint64_t opcode = strtoull(op.c_str(), nullptr, 16);
+  struct stat st;
+  void* map = MAP_FAILED;
+  if (fstat(STDIN_FILENO, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
+    map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, STDIN_FILENO, 0);
 
-      if (bit_num<64){
-          opcode = opcode << (64-bit_num) >> (64-bit_num);
+  if (map != MAP_FAILED) {
+    madvise(map, st.st_size, MADV_SEQUENTIAL);
+    const char* data = (const char*)map;
+    const char* end = data + st.st_size;
+    while (data < end) {
+      const char* chunk_end = end;
+      if (size_t(end - data) > chunk_size) {
+        const char* split = data + chunk_size;
+        const char* eol = (const char*)memchr(split, '\n', end - split);
+        chunk_end = eol ? eol + 1 : end;
+      }
+      parse_chunk(disassembler, data, chunk_end, nthreads, hist);
+      data = chunk_end;
+    }
+    munmap(map, st.st_size);
+  } else {
+    // keep the partial last line of each read for the next chunk
+    vector<char> buf(chunk_size);
+    size_t len = 0;
+    while (true) {
+      if (len == buf.size())
+        buf.resize(buf.size() * 2);
+      ssize_t bytes = read(STDIN_FILENO, buf.data() + len, buf.size() - len);
+      if (bytes < 0 && errno == EINTR)
+        continue;
+      if (bytes <= 0) {
+        parse_chunk(disassembler, buf.data(), buf.data() + len, nthreads, hist);
+        break;
       }
+      len += bytes;
 
-      const disasm_insn_t* disasm = p.get_disassembler()->lookup(opcode);
-      if (disasm) {
-          cout << disasm->get_name() << '\n';
-      } else {
-          cout << "unknown_op\n";
+      const char* last_eol = (const char*)memrchr(buf.data(), '\n', len);
+      if (last_eol && len > buf.size() / 2) {
+        size_t used = last_eol + 1 - buf.data();
+        parse_chunk(disassembler, buf.data(), buf.data() + used, nthreads, hist);
+        memmove(buf.data(), buf.data() + used, len - used);
+        len -= used;
       }
     }
   }
 
+  if (histogram_mode)
+    print_histogram(histogram);
+
   return 0;
 }
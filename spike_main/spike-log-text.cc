@@ -0,0 +1,55 @@
+// See LICENSE for license details.
+
+// This little program converts a binary commit log, as written by
+//   spike --log-commits --log-commits-format=binary --log=<file>
+// into the text commit log that spike --log-commits would have written.
+// It reads the named file, or stdin if there is none, and writes stdout.
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "commit_log.h"
+
+static bool read_all(FILE *f, void *data, size_t len)
+{
+  return fread(data, 1, len, f) == len;
+}
+
+int main(int argc, char** argv)
+{
+  if (argc > 2) {
+    fprintf(stderr, "usage: %s [<binary commit log>]\n", argv[0]);
+    return 1;
+  }
+
+  FILE *in = stdin;
+  if (argc == 2 && !(in = fopen(argv[1], "rb"))) {
+    fprintf(stderr, "Failed to open %s: %s\n", argv[1], strerror(errno));
+    return 1;
+  }
+
+  commit_log_file_header_t header;
+  if (!read_all(in, &header, sizeof(header)) ||
+      memcmp(header.magic, COMMIT_LOG_MAGIC, sizeof(header.magic)) != 0 ||
+      header.version != COMMIT_LOG_VERSION) {
+    fprintf(stderr, "Not a binary commit log (version %d)\n", COMMIT_LOG_VERSION);
+    return 1;
+  }
+
+  std::vector<char> buf(sizeof(commit_log_rec_t));
+  while (read_all(in, buf.data(), sizeof(commit_log_rec_t))) {
+    uint32_t size = ((const commit_log_rec_t *)buf.data())->size;
+    if (size < sizeof(commit_log_rec_t)) {
+      fprintf(stderr, "Corrupt binary commit log\n");
+      return 1;
+    }
+    buf.resize(size);
+    if (!read_all(in, buf.data() + sizeof(commit_log_rec_t), size - sizeof(commit_log_rec_t))) {
+      fprintf(stderr, "Truncated binary commit log\n");
+      return 1;
+    }
+    commit_log_print_text(stdout, (const commit_log_rec_t *)buf.data(), header.vlen);
+  }
+
+  return 0;
+}
@@ -31,8 +31,28 @@ static void help(int exit_code = 1)
   fprintf(stderr, "  -m<n>                 Provide <n> MiB of target memory [default 2048]\n");
   fprintf(stderr, "  -m<a:m,b:n,...>       Provide memory regions of size m and n bytes\n");
   fprintf(stderr, "                          at base addresses a and b (with 4 KiB alignment)\n");
+  fprintf(stderr, "  -m<a:m:<opt>,...>     Append host placement options to a region:\n");
+  fprintf(stderr, "                          hugepages   back it with transparent hugepages\n");
+  fprintf(stderr, "                          numa=<n>    bind it to host NUMA node n\n");
+  fprintf(stderr, "                          path=<file> map a host file (copy-on-write)\n");
+  fprintf(stderr, "                          shm=<name>  map a POSIX shared memory object\n");
+  fprintf(stderr, "                          shared      write guest stores back to path\n");
+  fprintf(stderr, "                          (use target program 'none' with --pc to boot\n");
+  fprintf(stderr, "                          a preloaded image without loading an ELF)\n");
   fprintf(stderr, "  -d                    Interactive debug mode\n");
   fprintf(stderr, "  -g                    Track histogram of PCs\n");
+  fprintf(stderr, "  --insn-profile        Count executed instructions by mnemonic, group and\n");
+  fprintf(stderr, "                          privilege mode, without leaving the fast path\n");
+  fprintf(stderr, "  --sample-profile=<n>  Sample each hart's pc and call stack every <n>\n");
+  fprintf(stderr, "                          instructions, and print them as folded stacks\n");
+  fprintf(stderr, "                          for flamegraph.pl. Call stacks need frame pointers\n");
+  fprintf(stderr, "                          (-fno-omit-frame-pointer) or a Zicfiss shadow stack.\n");
+  fprintf(stderr, "  --sample-profile-log=<name>\n");
+  fprintf(stderr, "                        File name for option --sample-profile [default stderr]\n");
+  fprintf(stderr, "  --bbv=<n>             Write each hart's basic-block vectors for SimPoint\n");
+  fprintf(stderr, "                          every <n> instructions\n");
+  fprintf(stderr, "  --bbv-log=<name>      File name for option --bbv, with .<hartid> appended\n");
+  fprintf(stderr, "                          if there are several harts [default stderr]\n");
   fprintf(stderr, "  -l                    Generate a log of execution\n");
 #ifdef HAVE_BOOST_ASIO
   fprintf(stderr, "  -s                    Command I/O via socket (use with -d)\n");
@@ -50,12 +70,33 @@ static void help(int exit_code = 1)
   fprintf(stderr, "  --ic=<S>:<W>:<B>      Instantiate a cache model with S sets,\n");
   fprintf(stderr, "  --dc=<S>:<W>:<B>        W ways, and B-byte blocks (with S and\n");
   fprintf(stderr, "  --l2=<S>:<W>:<B>        B both powers of 2).\n");
+  fprintf(stderr, "  --fast-forward=<a,b,...>\n");
+  fprintf(stderr, "                        Run without the cache models, except for a window\n");
+  fprintf(stderr, "                          at each of instructions a, b, ...\n");
+  fprintf(stderr, "  --cache-warmup=<n>    Attach the cache models n instructions before each\n");
+  fprintf(stderr, "                          window, to warm them up [default 0]\n");
+  fprintf(stderr, "  --cache-measure=<n>   Print cache statistics over the n instructions of\n");
+  fprintf(stderr, "                          each window\n");
   fprintf(stderr, "  --big-endian          Use a big-endian memory system.\n");
   fprintf(stderr, "  --misaligned          Support misaligned memory accesses\n");
+  fprintf(stderr, "  --host-fpu            Compute round-to-nearest-even F/D arithmetic with the\n");
+  fprintf(stderr, "                          host FPU when its results match softfloat exactly\n");
   fprintf(stderr, "  --device=<name>       Attach MMIO plugin device from an --extlib library,\n");
   fprintf(stderr, "                          specify --device=<name>,<args> to pass down extra args.\n");
   fprintf(stderr, "  --log-cache-miss      Generate a log of cache miss\n");
   fprintf(stderr, "  --log-commits         Generate a log of commits info\n");
+  fprintf(stderr, "  --log-commits-format=<text|binary>\n");
+  fprintf(stderr, "                        Format of the commits log [default text]. The binary\n");
+  fprintf(stderr, "                          format needs --log and is converted to text with\n");
+  fprintf(stderr, "                          spike-log-text\n");
+  fprintf(stderr, "  --log-commits-range=<lo>:<hi>\n");
+  fprintf(stderr, "                        Log only commits with lo <= pc < hi\n");
+  fprintf(stderr, "  --log-commits-priv=<M|S|U...>\n");
+  fprintf(stderr, "                        Log only commits in the given privilege modes\n");
+  fprintf(stderr, "  --log-commits-window=<start>:<count>\n");
+  fprintf(stderr, "                        Log only commits of the count instructions each hart\n");
+  fprintf(stderr, "                          retires after its first start instructions.\n");
+  fprintf(stderr, "                          Unlogged instructions run at full speed.\n");
   fprintf(stderr, "  --extension=<name>    Specify RoCC Extension\n");
   fprintf(stderr, "                          This flag can be used multiple times.\n");
   fprintf(stderr, "  --extlib=<name>       Shared library to load\n");
@@ -85,6 +126,19 @@ static void help(int exit_code = 1)
   fprintf(stderr, "  --dm-no-impebreak     Debug module won't support implicit ebreak in program buffer\n");
   fprintf(stderr, "  --blocksz=<size>      Cache block size (B) for CMO operations(powers of 2) [default 64]\n");
   fprintf(stderr, "  --instructions=<n>    Stop after n instructions\n");
+  fprintf(stderr, "  --checkpoint-save=<file>@<n>\n");
+  fprintf(stderr, "                        Save the whole system to file after n instructions\n");
+  fprintf(stderr, "                          (counted like --instructions), and keep running\n");
+  fprintf(stderr, "  --checkpoint-restore=<file>\n");
+  fprintf(stderr, "                        Resume from a checkpoint once the program is loaded.\n");
+  fprintf(stderr, "                          Use the same options and program as when saving.\n");
+  fprintf(stderr, "  --fork-at=<n>         After n instructions, fork a child per --fork-config\n");
+  fprintf(stderr, "                          to run on from there, and exit when they all have\n");
+  fprintf(stderr, "                          (not with --sample-profile, --bbv, a binary commit\n");
+  fprintf(stderr, "                          log, or memory mapped with shm= or :shared)\n");
+  fprintf(stderr, "  --fork-config=<c>     Configure a --fork-at child (may be repeated): c is a\n");
+  fprintf(stderr, "                          comma-separated list of ic=, dc=, l2=<S>:<W>:<B>,\n");
+  fprintf(stderr, "                          out=<file> and load=<file>@<hex addr>\n");
 
   exit(exit_code);
 }
@@ -152,7 +206,12 @@ static mem_cfg_t merge_mem_regions(const mem_cfg_t& L, const mem_cfg_t& R)
   const auto merged_end_incl = std::max(L.get_inclusive_end(), R.get_inclusive_end());
   const auto merged_size = merged_end_incl - merged_base + 1;
 
-  return mem_cfg_t(merged_base, merged_size);
+  mem_backing_cfg_t merged_backing = L.get_backing();
+  merged_backing.hugepages |= R.get_backing().hugepages;
+  if (!merged_backing.numa_node)
+    merged_backing.numa_node = R.get_backing().numa_node;
+
+  return mem_cfg_t(merged_base, merged_size, merged_backing);
 }
 
 // check the user specified memory regions and merge the overlapping or
@@ -174,6 +233,13 @@ merge_overlapping_memory_regions(std::vector<mem_cfg_t> mems)
       merged_mem.push_back(mem_int);
       continue;
     }
+    // a region mapped from a host file has a fixed layout and can't grow
+    if (!merged_mem.back().get_backing().path.empty() ||
+        !mem_int.get_backing().path.empty()) {
+      fprintf(stderr, "File-backed memory region at 0x%" PRIx64 " overlaps another region\n",
+              mem_int.get_base());
+      exit(EXIT_FAILURE);
+    }
     // there is a weird corner case preventing two memory regions from being
     // merged: if the resulting size of a region is 2^64 bytes - currently,
     // such regions are not representable by mem_cfg_t class (because the
@@ -192,7 +258,8 @@ merge_overlapping_memory_regions(std::vector<mem_cfg_t> mems)
   return merged_mem;
 }
 
-static mem_cfg_t create_mem_region(unsigned long long base, unsigned long long size)
+static mem_cfg_t create_mem_region(unsigned long long base, unsigned long long size,
+                                   const mem_backing_cfg_t& backing = {})
 {
   // page-align base and size
   auto base0 = base, size0 = size;
@@ -214,7 +281,36 @@ static mem_cfg_t create_mem_region(unsigned long long base, unsigned long long s
     exit(EXIT_FAILURE);
   }
 
-  return mem_cfg_t(base, size);
+  return mem_cfg_t(base, size, backing);
+}
+
+// parse one ":<opt>" suffix of a base/size tuple, returning the end of it
+static const char* parse_mem_backing_option(const char* arg, mem_backing_cfg_t* backing)
+{
+  const char* end = arg + strcspn(arg, ":,");
+  const std::string opt(arg, end);
+
+  if (opt == "hugepages") {
+    backing->hugepages = true;
+  } else if (opt.rfind("numa=", 0) == 0) {
+    char* p;
+    auto node = strtoul(opt.c_str() + strlen("numa="), &p, 0);
+    if (*p || p == opt.c_str() + strlen("numa="))
+      help();
+    backing->numa_node = node;
+  } else if (opt.rfind("path=", 0) == 0) {
+    backing->path = opt.substr(strlen("path="));
+  } else if (opt.rfind("shm=", 0) == 0) {
+    backing->path = opt.substr(strlen("shm="));
+    backing->shm = true;
+  } else if (opt == "shared") {
+    backing->shared = true;
+  } else {
+    fprintf(stderr, "Unknown memory region option '%s'\n", opt.c_str());
+    help();
+  }
+
+  return end;
 }
 
 static std::vector<mem_cfg_t> parse_mem_layout(const char* arg)
@@ -239,7 +335,17 @@ static std::vector<mem_cfg_t> parse_mem_layout(const char* arg)
       help();
     auto size = strtoull(p + 1, &p, 0);
 
-    res.push_back(create_mem_region(base, size));
+    mem_backing_cfg_t backing;
+    const char* opts = p;
+    while (*opts == ':')
+      opts = parse_mem_backing_option(opts + 1, &backing);
+    p = const_cast<char*>(opts);
+    if (backing.shared && backing.path.empty()) {
+      fprintf(stderr, "Memory region option 'shared' needs path= or shm=\n");
+      help();
+    }
+
+    res.push_back(create_mem_region(base, size, backing));
 
     if (!*p)
       break;
@@ -259,7 +365,7 @@ static std::vector<std::pair<reg_t, abstract_mem_t*>> make_mems(const std::vecto
   std::vector<std::pair<reg_t, abstract_mem_t*>> mems;
   mems.reserve(layout.size());
   for (const auto &cfg : layout) {
-    mems.push_back(std::make_pair(cfg.get_base(), new mem_t(cfg.get_size())));
+    mems.push_back(std::make_pair(cfg.get_base(), new mem_t(cfg.get_size(), cfg.get_backing())));
   }
   return mems;
 }
@@ -281,6 +387,36 @@ static unsigned long atoul_nonzero_safe(const char* s)
   return res;
 }
 
+// <a>:<b>, e.g. for --log-commits-range
+static std::pair<reg_t, reg_t> parse_pair(const char* s)
+{
+  char* p;
+  auto first = strtoull(s, &p, 0);
+  if (p == s || *p != ':')
+    help();
+  s = p + 1;
+  auto second = strtoull(s, &p, 0);
+  if (p == s || *p)
+    help();
+  return std::make_pair(first, second);
+}
+
+static unsigned parse_priv_mask(const char* s)
+{
+  unsigned mask = 0;
+  for (; *s; s++) {
+    switch (toupper(*s)) {
+      case 'M': mask |= 1U << PRV_M; break;
+      case 'S': mask |= 1U << PRV_S; break;
+      case 'U': mask |= 1U << PRV_U; break;
+      default: help();
+    }
+  }
+  if (!mask)
+    help();
+  return mask;
+}
+
 static std::vector<size_t> parse_hartids(const char *s)
 {
   std::string const str(s);
@@ -314,11 +450,35 @@ static std::vector<size_t> parse_hartids(const char *s)
   return hartids;
 }
 
+static std::vector<reg_t> parse_steps(const char *s)
+{
+  std::vector<reg_t> steps;
+  std::stringstream stream(s);
+
+  reg_t n;
+  while (stream >> n) {
+    steps.push_back(n);
+    if (stream.peek() == ',') stream.ignore();
+  }
+
+  if (steps.empty() || !stream.eof()) {
+    fprintf(stderr, "Expected a comma-separated list of instruction counts, not %s\n", s);
+    exit(1);
+  }
+
+  return steps;
+}
+
 int main(int argc, char** argv)
 {
   bool debug = false;
   bool halted = false;
   bool histogram = false;
+  bool insn_profile = false;
+  reg_t sample_period = 0;
+  const char *sample_profile_path = nullptr;
+  reg_t bbv_interval = 0;
+  const char *bbv_path = nullptr;
   bool log = false;
   bool UNUSED socket = false;  // command line option -s
   bool dump_dts = false;
@@ -330,7 +490,12 @@ int main(int argc, char** argv)
   std::unique_ptr<dcache_sim_t> dc;
   std::unique_ptr<cache_sim_t> l2;
   bool log_cache = false;
+  std::vector<reg_t> fast_forward;
+  reg_t cache_warmup = 0;
+  reg_t cache_measure = 0;
   bool log_commits = false;
+  bool binary_log_commits = false;
+  commit_log_filter_t log_commits_filter;
   const char *log_path = nullptr;
   std::vector<std::function<extension_t*()>> extensions;
   const char* initrd = NULL;
@@ -340,6 +505,11 @@ int main(int argc, char** argv)
   unsigned dmi_rti = 0;
   reg_t blocksz = 64;
   std::optional<unsigned long long> instructions;
+  std::string checkpoint_save_path;
+  reg_t checkpoint_save_steps = 0;
+  const char *checkpoint_restore_path = nullptr;
+  std::optional<reg_t> fork_steps;
+  std::vector<std::string> fork_configs;
   debug_module_config_t dm_config;
   cfg_arg_t<size_t> nprocs(1);
 
@@ -371,6 +541,11 @@ int main(int argc, char** argv)
   parser.option('h', "help", 0, [&](const char UNUSED *s){help(0);});
   parser.option('d', 0, 0, [&](const char UNUSED *s){debug = true;});
   parser.option('g', 0, 0, [&](const char UNUSED *s){histogram = true;});
+  parser.option(0, "insn-profile", 0, [&](const char UNUSED *s){insn_profile = true;});
+  parser.option(0, "sample-profile", 1, [&](const char* s){sample_period = atoul_nonzero_safe(s);});
+  parser.option(0, "sample-profile-log", 1, [&](const char* s){sample_profile_path = s;});
+  parser.option(0, "bbv", 1, [&](const char* s){bbv_interval = atoul_nonzero_safe(s);});
+  parser.option(0, "bbv-log", 1, [&](const char* s){bbv_path = s;});
   parser.option('l', 0, 0, [&](const char UNUSED *s){log = true;});
 #ifdef HAVE_BOOST_ASIO
   parser.option('s', 0, 0, [&](const char UNUSED *s){socket = true;});
@@ -387,8 +562,12 @@ int main(int argc, char** argv)
   parser.option(0, "ic", 1, [&](const char* s){ic.reset(new icache_sim_t(s));});
   parser.option(0, "dc", 1, [&](const char* s){dc.reset(new dcache_sim_t(s));});
   parser.option(0, "l2", 1, [&](const char* s){l2.reset(cache_sim_t::construct(s, "L2$"));});
+  parser.option(0, "fast-forward", 1, [&](const char* s){fast_forward = parse_steps(s);});
+  parser.option(0, "cache-warmup", 1, [&](const char* s){cache_warmup = atoul_safe(s);});
+  parser.option(0, "cache-measure", 1, [&](const char* s){cache_measure = atoul_nonzero_safe(s);});
   parser.option(0, "big-endian", 0, [&](const char UNUSED *s){cfg.endianness = endianness_big;});
   parser.option(0, "misaligned", 0, [&](const char UNUSED *s){cfg.misaligned = true;});
+  parser.option(0, "host-fpu", 0, [&](const char UNUSED *s){cfg.host_fpu = true;});
   parser.option(0, "log-cache-miss", 0, [&](const char UNUSED *s){log_cache = true;});
   parser.option(0, "isa", 1, [&](const char* s){cfg.isa = s;});
   parser.option(0, "pmpregions", 1, [&](const char* s){cfg.pmpregions = atoul_safe(s);});
@@ -433,6 +612,26 @@ int main(int argc, char** argv)
       [&](const char UNUSED *s){dm_config.support_haltgroups = false;});
   parser.option(0, "log-commits", 0,
                 [&](const char UNUSED *s){log_commits = true;});
+  parser.option(0, "log-commits-format", 1, [&](const char* s){
+    if (strcmp(s, "binary") == 0)
+      binary_log_commits = true;
+    else if (strcmp(s, "text") != 0)
+      help();
+  });
+  parser.option(0, "log-commits-range", 1, [&](const char* s){
+    log_commits = true;
+    log_commits_filter.pc_range = parse_pair(s);
+    if (log_commits_filter.pc_range->first >= log_commits_filter.pc_range->second)
+      help();
+  });
+  parser.option(0, "log-commits-priv", 1, [&](const char* s){
+    log_commits = true;
+    log_commits_filter.priv_mask = parse_priv_mask(s);
+  });
+  parser.option(0, "log-commits-window", 1, [&](const char* s){
+    log_commits = true;
+    log_commits_filter.window = parse_pair(s);
+  });
   parser.option(0, "log", 1,
                 [&](const char* s){log_path = s;});
   FILE *cmd_file = NULL;
@@ -456,6 +655,18 @@ int main(int argc, char** argv)
   parser.option(0, "instructions", 1, [&](const char* s){
     instructions = strtoull(s, 0, 0);
   });
+  parser.option(0, "checkpoint-save", 1, [&](const char* s){
+    const char* at = strrchr(s, '@');
+    if (!at || at == s) {
+      fprintf(stderr, "--checkpoint-save must be of the form <file>@<n>\n");
+      exit(1);
+    }
+    checkpoint_save_path.assign(s, at);
+    checkpoint_save_steps = atoul_safe(at + 1);
+  });
+  parser.option(0, "checkpoint-restore", 1, [&](const char* s){checkpoint_restore_path = s;});
+  parser.option(0, "fork-at", 1, [&](const char* s){fork_steps = atoul_safe(s);});
+  parser.option(0, "fork-config", 1, [&](const char* s){fork_configs.push_back(s);});
 
   auto argv1 = parser.parse(argv);
   std::vector<std::string> htif_args(argv1, (const char*const*)argv + argc);
@@ -481,6 +692,18 @@ int main(int argc, char** argv)
     }
   }
 
+  // An initrd that is already mapped as a file-backed region needs no copy
+  if (initrd) {
+    for (const auto& m : cfg.mem_layout) {
+      if (m.get_backing().path == initrd && !m.get_backing().shm) {
+        reg_t initrd_size = std::min(reg_t(get_file_size(initrd)), m.get_size());
+        cfg.initrd_bounds = std::make_pair(m.get_base(), m.get_base() + initrd_size);
+        initrd = NULL;
+        break;
+      }
+    }
+  }
+
   if (initrd && check_file_exists(initrd)) {
     size_t initrd_size = get_file_size(initrd);
     for (auto& m : mems) {
@@ -536,17 +759,48 @@ int main(int argc, char** argv)
   if (dc && l2) dc->set_miss_handler(&*l2);
   if (ic) ic->set_log(log_cache);
   if (dc) dc->set_log(log_cache);
+  s.set_cache_models(ic.get(), dc.get(), l2.get());
   for (size_t i = 0; i < cfg.nprocs(); i++)
   {
-    if (ic) s.get_core(i)->get_mmu()->register_memtracer(&*ic);
-    if (dc) s.get_core(i)->get_mmu()->register_memtracer(&*dc);
     for (auto e : extensions)
       s.get_core(i)->register_extension(e());
   }
 
+  if (log_commits && binary_log_commits && (!log_path || log)) {
+    fprintf(stderr, "--log-commits-format=binary needs --log and can't be combined with -l\n");
+    exit(1);
+  }
+
   s.set_debug(debug);
-  s.configure_log(log, log_commits);
+  s.configure_log(log, log_commits, binary_log_commits, log_commits_filter);
   s.set_histogram(histogram);
+  s.set_insn_profile(insn_profile);
+  if (sample_period)
+    s.set_sample_profile(sample_period, sample_profile_path);
+  if (bbv_interval) {
+    if (cfg.nprocs() > 1 && !bbv_path) {
+      fprintf(stderr, "--bbv with several harts needs --bbv-log\n");
+      exit(1);
+    }
+    s.set_bbv_profile(bbv_interval, bbv_path);
+  }
+  if (!fast_forward.empty()) {
+    if ((!ic && !dc) || !cache_measure) {
+      fprintf(stderr, "--fast-forward needs --ic or --dc, and --cache-measure\n");
+      exit(1);
+    }
+    s.set_cache_windows(fast_forward, cache_warmup, cache_measure);
+  }
+  if (!checkpoint_save_path.empty())
+    s.set_checkpoint_save(checkpoint_save_path.c_str(), checkpoint_save_steps);
+  if (checkpoint_restore_path)
+    s.set_checkpoint_restore(checkpoint_restore_path);
+  if (fork_steps.has_value() != !fork_configs.empty()) {
+    fprintf(stderr, "--fork-at and --fork-config must be used together\n");
+    exit(1);
+  }
+  if (fork_steps.has_value())
+    s.set_fork(*fork_steps, fork_configs);
 
   auto return_code = s.run();
 